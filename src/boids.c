@@ -7,9 +7,22 @@
 
 #include "boids.h"
 #include "spatial_hash.h"
+#include "compact_state.h"
 #include "normal_random.h"
 
-Boid boids[MAX_BOIDS + 2]; // +1 for predator, +1 for mouse
+Boid *boids = NULL; // boid_count + 1 for predator, +1 for mouse
+int boid_count = MAX_BOIDS;
+float fixed_time_step = 0.0f;
+
+BoidParams boid_params = {
+    .neighborRadius = 50.0f,
+    .protectedRadius = 10.0f,
+    .predatorRadius = 50.0f,
+    .avoidFactor = 0.15f,
+    .matchFactor = 0.1f,
+    .centerFactor = 0.001f,
+    .predatorAvoidFactor = 25.0f,
+};
 
 Vector2 Vector2SubtractTorus(Vector2 a, Vector2 b) {
     Vector2 diff = { a.x - b.x, a.y - b.y };
@@ -34,32 +47,48 @@ float DistanceOnTorus(Vector2 a, Vector2 b)
     return sqrtf(dx * dx + dy * dy);
 }
 
+void InitBoid(Boid *boid, int id) {
+    *boid = (Boid){ .id = id, .neighborCount = -1, .nearNeighborCount = -1 };
+    boid->position = (Vector2){ GetRandomValue(0, SCREEN_WIDTH) - 1, GetRandomValue(0, SCREEN_HEIGHT) - 1};
+    float angle = GetRandomValue(0, 360) * DEG2RAD;
+    float speed = random_normal(4.0f, 3.0f);
+    boid->velocity = Vector2Scale((Vector2){ cosf(angle), sinf(angle) }, speed);
+}
+
+Boid InitialPredator(void) {
+    return (Boid){
+        .id = -1,
+        .position = { SCREEN_WIDTH/2, SCREEN_HEIGHT/2 },
+        .velocity = { PREDATOR_SPEED, PREDATOR_SPEED },
+        .isPredator = true,
+    };
+}
+
 void InitBoids() {
+    Boid *resized = realloc(boids, (boid_count + 2) * sizeof(Boid));
+    if (!resized) {
+        fprintf(stderr, "Failed to allocate %d boids!\n", boid_count);
+        exit(1);
+    }
+    boids = resized;
+
     // Initialize spatial hash
     init_spatial_hash();
 
     // Initialize boids
-    for (int i = 0; i < MAX_BOIDS; i++) {
-        boids[i].position = (Vector2){ GetRandomValue(0, SCREEN_WIDTH) - 1, GetRandomValue(0, SCREEN_HEIGHT) - 1};
-        float angle = GetRandomValue(0, 360) * DEG2RAD;
-        float speed = random_normal(4.0f, 3.0f);
-        boids[i].velocity = Vector2Scale((Vector2){ cosf(angle), sinf(angle) }, speed);
-        boids[i].isPredator = false;
-        boids[i].neighborCount = -1;
-        boids[i].nearNeighborCount = -1;
+    for (int i = 0; i < boid_count; i++) {
+        InitBoid(&boids[i], i);
         insert_boid(&boids[i]);
     }
     // Predator
-    boids[PREDATOR_INDEX].position = (Vector2){ SCREEN_WIDTH/2, SCREEN_HEIGHT/2 };
-    printf("Predator position: (%.2f, %.2f)\n", boids[PREDATOR_INDEX].position.x, boids[PREDATOR_INDEX].position.y);
-    boids[PREDATOR_INDEX].velocity = (Vector2){ PREDATOR_SPEED, PREDATOR_SPEED };
-    boids[PREDATOR_INDEX].isPredator = true;
+    boids[PREDATOR_INDEX] = InitialPredator();
     //insert_boid(&boids[PREDATOR_INDEX]);
 
     // Mouse
     boids[MOUSE_INDEX].position = (Vector2){ -1.0f, -1.0f };
     boids[MOUSE_INDEX].velocity = (Vector2){ 0.0f, 0.0f };
     boids[MOUSE_INDEX].isPredator = false;
+    boids[MOUSE_INDEX].id = -2;
 
 }
 
@@ -74,76 +103,75 @@ Vector2 Vector2Wrap(Vector2 v, float width, float height)
     return v;
 }
 
-void UpdateBoids(float alignmentWeight, float cohesionWeight, float separationWeight)
+float SimulationStepScale(void)
 {
-    // Parallel update stage
-    #pragma omp parallel for schedule(static)
-    for (int boid_index = 0; boid_index < MAX_BOIDS; boid_index++) {
-        Boid* self = &boids[boid_index];
-
-        // Initialize updates
-        self->velocity_update = self->velocity;
-        self->position_update = self->position;
-
-        // Compute flocking forces
-        // ComputeFlockForces() is a function that computes the alignment, cohesion, and separation forces
-        FlockForces forces = ComputeFlockForces(self);
-        self->neighborCount = forces.neighborCount;
-        self->nearNeighborCount = forces.nearNeighborCount;
-
-        // Apply flocking behaviour
-        if (forces.neighborCount > 0) {
-            Vector2 align_force = Vector2Subtract(forces.alignment, self->velocity);
-            self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(align_force, MATCH_FACTOR * alignmentWeight));
-
-            Vector2 cohesion_force = Vector2Subtract(forces.cohesion, self->position);
-            self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(cohesion_force, CENTER_FACTOR * cohesionWeight));
-        }
-        self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(forces.separation, AVOID_FACTOR * separationWeight));
+    return (fixed_time_step > 0.0f ? fixed_time_step : GetFrameTime()) * 60.0f;
+}
 
-        // Predator avoidance
-        Vector2 predatorVec = Vector2SubtractTorus(self->position, boids[PREDATOR_INDEX].position);
-        float distToPredator = Vector2Length(predatorVec);
-        if (distToPredator < PREDATOR_RADIUS) {
-            self->predated = true;
-            if (distToPredator != 0)
-                predatorVec = Vector2Scale(predatorVec, PREDATOR_AVOID_FACTOR / distToPredator);
-            self->velocity_update = Vector2Add(self->velocity_update, predatorVec);
-        }
-        else {
-            self->predated = false;
-        }
+// Computes boid_index's velocity_update and position_update from the current
+// spatial hash; nothing is committed.
+void SteerBoid(int boid_index, float alignmentWeight, float cohesionWeight, float separationWeight, float step_scale)
+{
+    Boid* self = &boids[boid_index];
 
-        // Mouse
-        if (mousePressed) {
-            Vector2 mouseVec = Vector2SubtractTorus(self->position, boids[MOUSE_INDEX].position);
-            float distToMouse = Vector2Length(mouseVec);
-            if (distToMouse < MOUSE_RADIUS) {
-                self->predated = true;
-                if (distToMouse != 0) mouseVec = Vector2Scale(mouseVec, - MOUSE_ATTRACTION_FACTOR / distToMouse);
-                self->velocity_update = Vector2Add(self->velocity_update, mouseVec);
-            }
-        }
+    // Initialize updates
+    self->velocity_update = self->velocity;
+    self->position_update = self->position;
 
-        // Speed limiting
-        self->velocity_update = Vector2ClampValue(self->velocity_update, MIN_SPEED, MAX_SPEED);
+    // Compute flocking forces
+    // ComputeFlockForces() is a function that computes the alignment, cohesion, and separation forces
+    FlockForces forces = compactState ? ComputeFlockForcesCompact(boid_index) : ComputeFlockForces(self);
+    self->neighborCount = forces.neighborCount;
+    self->nearNeighborCount = forces.nearNeighborCount;
 
-        // Predict next position
-        self->position_update = Vector2Add(self->position, Vector2Scale(self->velocity_update, GetFrameTime() * 60.0f));
+    // Apply flocking behaviour
+    if (forces.neighborCount > 0) {
+        Vector2 align_force = Vector2Subtract(forces.alignment, self->velocity);
+        self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(align_force, MATCH_FACTOR * alignmentWeight));
 
-        // Screen wrap
-        self->position_update = Vector2Wrap(self->position_update, SCREEN_WIDTH, SCREEN_HEIGHT);
+        Vector2 cohesion_force = Vector2Subtract(forces.cohesion, self->position);
+        self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(cohesion_force, CENTER_FACTOR * cohesionWeight));
+    }
+    self->velocity_update = Vector2Add(self->velocity_update, Vector2Scale(forces.separation, AVOID_FACTOR * separationWeight));
+
+    // Predator avoidance
+    Vector2 predatorVec = Vector2SubtractTorus(self->position, boids[PREDATOR_INDEX].position);
+    float distToPredator = Vector2Length(predatorVec);
+    if (distToPredator < PREDATOR_RADIUS) {
+        self->predated = true;
+        if (distToPredator != 0)
+            predatorVec = Vector2Scale(predatorVec, PREDATOR_AVOID_FACTOR / distToPredator);
+        self->velocity_update = Vector2Add(self->velocity_update, predatorVec);
+    }
+    else {
+        self->predated = false;
     }
 
-    // Commit updates and rebuild spatial hash (serial)
-    clear_spatial_hash();
-
-    for (int i = 0; i < MAX_BOIDS; i++) {
-        boids[i].velocity = boids[i].velocity_update;
-        boids[i].position = boids[i].position_update;
-        insert_boid(&boids[i]);
+    // Mouse
+    if (mousePressed) {
+        Vector2 mouseVec = Vector2SubtractTorus(self->position, boids[MOUSE_INDEX].position);
+        float distToMouse = Vector2Length(mouseVec);
+        if (distToMouse < MOUSE_RADIUS) {
+            self->predated = true;
+            if (distToMouse != 0) mouseVec = Vector2Scale(mouseVec, - MOUSE_ATTRACTION_FACTOR / distToMouse);
+            self->velocity_update = Vector2Add(self->velocity_update, mouseVec);
+        }
     }
 
+    // Speed limiting
+    self->velocity_update = Vector2ClampValue(self->velocity_update, MIN_SPEED, MAX_SPEED);
+
+    // Predict next position
+    self->position_update = Vector2Add(self->position, Vector2Scale(self->velocity_update, step_scale));
+
+    // Screen wrap
+    self->position_update = Vector2Wrap(self->position_update, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+// Steers and moves the predator, then inserts it into the spatial hash.
+// Expects the hash to hold the committed boid positions.
+void MovePredator(float step_scale)
+{
     // Move predator before inserting it
     boids[PREDATOR_INDEX].velocity = Vector2Add(
         boids[PREDATOR_INDEX].velocity,
@@ -158,7 +186,7 @@ void UpdateBoids(float alignmentWeight, float cohesionWeight, float separationWe
 
     boids[PREDATOR_INDEX].position = Vector2Add(
         boids[PREDATOR_INDEX].position,
-        Vector2Scale(boids[PREDATOR_INDEX].velocity, GetFrameTime() * 60.0f)
+        Vector2Scale(boids[PREDATOR_INDEX].velocity, step_scale)
     );
 
     boids[PREDATOR_INDEX].position = Vector2Wrap(
@@ -170,6 +198,30 @@ void UpdateBoids(float alignmentWeight, float cohesionWeight, float separationWe
     insert_boid(&boids[PREDATOR_INDEX]);
 }
 
+void UpdateBoids(float alignmentWeight, float cohesionWeight, float separationWeight)
+{
+    float step_scale = SimulationStepScale();
+
+    if (compactState) build_compact_state();
+
+    // Parallel update stage
+    #pragma omp parallel for schedule(static)
+    for (int boid_index = 0; boid_index < boid_count; boid_index++) {
+        SteerBoid(boid_index, alignmentWeight, cohesionWeight, separationWeight, step_scale);
+    }
+
+    // Commit updates and rebuild spatial hash (serial)
+    clear_spatial_hash();
+
+    for (int i = 0; i < boid_count; i++) {
+        boids[i].velocity = boids[i].velocity_update;
+        boids[i].position = boids[i].position_update;
+        insert_boid(&boids[i]);
+    }
+
+    MovePredator(step_scale);
+}
+
 static Color colors[11] = {
     (Color){  0,  40,  82, 255},  // Deep Blue (20% darker)
     (Color){  0,  60, 122, 255},
@@ -197,13 +249,17 @@ int int_log2(int x) {
     return log;
 }
 
+Color DensityColor(int neighbors) {
+    return colors[int_log2(neighbors)];
+}
+
 int number_drawn = 0;
 
 void DrawBoid(Boid *boid) {
     number_drawn++;
     float size = BOID_RADIUS;
     Vector2 topLeft = { boid->position.x - size / 2, boid->position.y - size / 2 };
-    Color color =  drawDensity ? colors[int_log2(boid->neighborCount + boid->nearNeighborCount)] : DARKGRAY;
+    Color color =  drawDensity ? DensityColor(boid->neighborCount + boid->nearNeighborCount) : DARKGRAY;
     color = debugBoid == boid ? RED : color;
     DrawRectangleV(topLeft, (Vector2){size, size}, color);
     if (drawFullGlyph) {
@@ -225,7 +281,7 @@ void DrawBoid(Boid *boid) {
 void DrawPreditor() {
     number_drawn++;
 
-    Boid *predator = &boids[MAX_BOIDS];
+    Boid *predator = &boids[PREDATOR_INDEX];
 
     // Normalize velocity to get direction
     Vector2 dir = Vector2Normalize(predator->velocity);
@@ -256,12 +312,12 @@ void DrawMouse(Boid boid) {
 
 void DrawBoids() {
     number_drawn = 0;
-    for (int i = 0; i < MAX_BOIDS; i++) DrawBoid(&boids[i]);
+    for (int i = 0; i < boid_count; i++) DrawBoid(&boids[i]);
     DrawPreditor();
     if (mousePressed) DrawMouse(boids[MOUSE_INDEX]);
 }
 
 void DrawNearestNeighborNetwork(){
-    for (int i = 0; i < MAX_BOIDS; i++) DrawNearestNeighbor(&boids[i]);
+    for (int i = 0; i < boid_count; i++) DrawNearestNeighbor(&boids[i]);
 }
 
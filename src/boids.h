@@ -5,22 +5,35 @@
 #include "raylib.h"
 #include "raymath.h"
 
-#define MAX_BOIDS 50000
-#define PREDATOR_INDEX MAX_BOIDS 
-#define MOUSE_INDEX (MAX_BOIDS + 1)
-
-
-#define NEIGHBOR_RADIUS 50.0f
-#define PROTECTED_RADIUS 10.0f
-#define PREDATOR_RADIUS 50.0f
+#define MAX_BOIDS 50000 // default population, see boid_count
+#define PREDATOR_INDEX boid_count
+#define MOUSE_INDEX (boid_count + 1)
+
+// Behaviour parameters that can be swept at runtime (see tools/ensemble.c).
+// The macros below keep the original names for the simulation code.
+typedef struct BoidParams {
+    float neighborRadius;   // must not exceed CELL_SIZE
+    float protectedRadius;
+    float predatorRadius;
+    float avoidFactor;
+    float matchFactor;
+    float centerFactor;
+    float predatorAvoidFactor;
+} BoidParams;
+
+extern BoidParams boid_params;
+
+#define NEIGHBOR_RADIUS (boid_params.neighborRadius)
+#define PROTECTED_RADIUS (boid_params.protectedRadius)
+#define PREDATOR_RADIUS (boid_params.predatorRadius)
 #define PREDATOR_VISUAL_RADIUS (PREDATOR_RADIUS * 3.0f)
 #define MOUSE_RADIUS 120.0f
 
-#define AVOID_FACTOR 0.15f
-#define MATCH_FACTOR 0.1f
-#define CENTER_FACTOR 0.001f
+#define AVOID_FACTOR (boid_params.avoidFactor)
+#define MATCH_FACTOR (boid_params.matchFactor)
+#define CENTER_FACTOR (boid_params.centerFactor)
 #define TURN_FACTOR 0.2f
-#define PREDATOR_AVOID_FACTOR 25.0f
+#define PREDATOR_AVOID_FACTOR (boid_params.predatorAvoidFactor)
 #define MOUSE_ATTRACTION_FACTOR 0.5f
 
 #define MAX_SPEED 4.5f
@@ -41,6 +54,7 @@ extern bool nearestNeighboursNetwork;
 
 // Boid structure
 typedef struct Boid {
+    int id;             // index at InitBoids(), kept when boids are moved around
     Vector2 position;
     Vector2 velocity;
     Vector2 position_update;
@@ -53,7 +67,14 @@ typedef struct Boid {
 
 extern Boid *debugBoid;
 
-extern Boid boids[MAX_BOIDS+2];
+// boid_count flocking boids followed by the predator and the mouse.
+// Set boid_count before InitBoids(), which (re)allocates the array.
+extern Boid *boids;
+extern int boid_count;
+
+// When non-zero UpdateBoids() advances by this many seconds per call
+// instead of the window frame time, so headless runs are reproducible.
+extern float fixed_time_step;
 
 typedef struct BoidNode {
     Boid* boid;
@@ -65,8 +86,20 @@ void clear_spatial_hash(void);
 void insert_boid(Boid* p);
 
 void InitBoids(void);
+
+// The pieces of InitBoids(). It draws boid ids 0..boid_count-1 in order
+// with InitBoid(), so a caller that does the same after the same seed gets
+// the same flock without holding all of it.
+void InitBoid(Boid *boid, int id);
+Boid InitialPredator(void);
 void UpdateBoids(float alignmentWeight, float cohesionWeight, float separationWeight);
+
+// The pieces of UpdateBoids(), for drivers that own a subset of the flock.
+float SimulationStepScale(void);
+void SteerBoid(int boid_index, float alignmentWeight, float cohesionWeight, float separationWeight, float step_scale);
+void MovePredator(float step_scale);
 void DrawBoids(void);
+Color DensityColor(int neighbors); // colour DrawBoids() uses with drawDensity
 void DrawNearestNeighborNetwork(void);
 
 extern int number_drawn;
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "compact_state.h"
+
+bool compactState = false;
+
+static CompactBoid *compact_boids = NULL;
+static int compact_capacity = 0;
+static int *cell_start = NULL;     // CELL_WIDTH * CELL_HEIGHT + 1 offsets
+static int cell_capacity = 0;
+static int *compact_slot = NULL;   // boid index -> position in compact_boids
+static int slot_capacity = 0;
+
+static void *grow(void *p, int *capacity, int needed, size_t size) {
+    if (needed <= *capacity) return p;
+    p = realloc(p, needed * size);
+    if (!p) {
+        fprintf(stderr, "Failed to allocate compact state!\n");
+        exit(1);
+    }
+    *capacity = needed;
+    return p;
+}
+
+static inline int cell_of(Vector2 position) {
+    int cell_x = (int)(position.x / CELL_SIZE);
+    int cell_y = (int)(position.y / CELL_SIZE);
+    return cell_y * CELL_WIDTH + cell_x;
+}
+
+static inline uint16_t quantize_offset(float offset) {
+    float q = offset * COMPACT_POSITION_SCALE;
+    if (q < 0.0f) return 0;
+    if (q > 65535.0f) return 65535;
+    return (uint16_t)lrintf(q);
+}
+
+static inline int16_t quantize_velocity(float v) {
+    float q = v * COMPACT_VELOCITY_SCALE;
+    if (q < -32767.0f) return -32767;
+    if (q > 32767.0f) return 32767;
+    return (int16_t)lrintf(q);
+}
+
+// Walks the hash rather than the boid array so the compact copy holds
+// exactly the boids the float path sees, in the same order within a cell.
+void build_compact_state(void) {
+    int cells = CELL_WIDTH * CELL_HEIGHT;
+    cell_start = grow(cell_start, &cell_capacity, cells + 1, sizeof(int));
+    compact_slot = grow(compact_slot, &slot_capacity, boid_count + 2, sizeof(int));
+
+    int total = 0;
+    for (int c = 0; c <= cells; c++) cell_start[c] = 0;
+    for (int i = 0; i < HASH_SIZE; i++) {
+        HashCell *bucket = &hash_table[i];
+        for (int j = 0; j < bucket->length; j++) cell_start[cell_of(bucket->boids[j]->position) + 1]++;
+        total += bucket->length;
+    }
+    for (int c = 0; c < cells; c++) cell_start[c + 1] += cell_start[c];
+
+    compact_boids = grow(compact_boids, &compact_capacity, total, sizeof(CompactBoid));
+
+    // cell_start[c] doubles as the fill pointer of cell c; afterwards each
+    // entry has reached the start of the next cell, so shift back by one.
+    for (int i = 0; i < HASH_SIZE; i++) {
+        HashCell *bucket = &hash_table[i];
+        for (int j = 0; j < bucket->length; j++) {
+            Boid *b = bucket->boids[j];
+            int cell = cell_of(b->position);
+            int slot = cell_start[cell]++;
+            float corner_x = (float)((cell % CELL_WIDTH) * CELL_SIZE);
+            float corner_y = (float)((cell / CELL_WIDTH) * CELL_SIZE);
+            compact_boids[slot] = (CompactBoid){
+                quantize_offset(b->position.x - corner_x),
+                quantize_offset(b->position.y - corner_y),
+                quantize_velocity(b->velocity.x),
+                quantize_velocity(b->velocity.y),
+            };
+            compact_slot[b - boids] = slot;
+        }
+    }
+    for (int c = cells; c > 0; c--) cell_start[c] = cell_start[c - 1];
+    cell_start[0] = 0;
+}
+
+// Same forces as ComputeFlockForces(), decoded from the compact copy. The
+// neighbouring cell's offset is known, so torus differences need no wrap
+// tests: the cell delta plus the in-cell offsets gives the displacement.
+FlockForces ComputeFlockForcesCompact(int boid_index) {
+    FlockForces forces = {0};
+    const Boid *boid = &boids[boid_index];
+
+    const float inv_position = 1.0f / COMPACT_POSITION_SCALE;
+    const float inv_velocity = 1.0f / COMPACT_VELOCITY_SCALE;
+
+    // The boid's own offset is decoded too, so coincident boids still give
+    // an exact zero displacement instead of a huge separation push.
+    int cell_x = (int)(boid->position.x / CELL_SIZE);
+    int cell_y = (int)(boid->position.y / CELL_SIZE);
+    int self_slot = compact_slot[boid_index];
+    float self_x = compact_boids[self_slot].x * inv_position;
+    float self_y = compact_boids[self_slot].y * inv_position;
+    const float protected2 = PROTECTED_RADIUS * PROTECTED_RADIUS;
+    const float neighbor2 = NEIGHBOR_RADIUS * NEIGHBOR_RADIUS;
+
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int cell = WRAP_MOD(cell_y + dy, CELL_HEIGHT) * CELL_WIDTH + WRAP_MOD(cell_x + dx, CELL_WIDTH);
+            float base_x = dx * CELL_SIZE - self_x;
+            float base_y = dy * CELL_SIZE - self_y;
+            for (int j = cell_start[cell]; j < cell_start[cell + 1]; ++j) {
+                if (j == self_slot) continue;
+                CompactBoid neighbor = compact_boids[j];
+                // Displacement from boid to neighbour
+                Vector2 diff = { base_x + neighbor.x * inv_position, base_y + neighbor.y * inv_position };
+                float dist2 = diff.x * diff.x + diff.y * diff.y;
+                if (dist2 < protected2) {
+                    Vector2 away = { -diff.x, -diff.y };
+                    if (dist2 != 0) away = Vector2Scale(away, 1.0f / dist2);
+                    forces.separation = Vector2Add(forces.separation, away);
+                    forces.nearNeighborCount++;
+                } else if (dist2 < neighbor2) {
+                    Vector2 velocity = { neighbor.vx * inv_velocity, neighbor.vy * inv_velocity };
+                    forces.alignment = Vector2Add(forces.alignment, velocity);
+                    forces.cohesion = Vector2Add(forces.cohesion, Vector2Add(diff, boid->position));
+                    forces.neighborCount++;
+                }
+            }
+        }
+    }
+    if (forces.neighborCount > 0) {
+        forces.alignment = Vector2Scale(forces.alignment, 1.0f / forces.neighborCount);
+        forces.cohesion = Vector2Scale(forces.cohesion, 1.0f / forces.neighborCount);
+    }
+    return forces;
+}
@@ -0,0 +1,32 @@
+#ifndef COMPACT_STATE_H
+#define COMPACT_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "boids.h"
+#include "spatial_hash.h"
+
+// Optional compact copy of the flock for the neighbour pass. Boids are
+// sorted by grid cell and stored as 16-bit fixed point: positions relative
+// to their cell corner, velocities in units of 1/4096. That is 8 bytes per
+// neighbour read instead of the 16 bytes of float position and velocity
+// fetched through the hash.
+
+#define COMPACT_POSITION_SCALE (65536.0f / CELL_SIZE)
+#define COMPACT_VELOCITY_SCALE 4096.0f // |v| < 8 covers PREDATOR_SPEED
+
+typedef struct CompactBoid {
+    uint16_t x;
+    uint16_t y;
+    int16_t vx;
+    int16_t vy;
+} CompactBoid;
+
+extern bool compactState;
+
+// Rebuilds the compact copy from the spatial hash; UpdateBoids() calls it
+// when compactState is set.
+void build_compact_state(void);
+FlockForces ComputeFlockForcesCompact(int boid_index);
+
+#endif // COMPACT_STATE_H
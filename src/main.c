@@ -2,6 +2,8 @@
 #include <omp.h>
 #include "boids.h"
 #include "spatial_hash.h"
+#include "compact_state.h"
+#include "shm_export.h"
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 
@@ -35,6 +37,11 @@ int main(void)
 
     InitBoids();
 
+    // BOIDS_SHM=/name publishes every step for external readers (tools/shm_reader.c)
+    const char *shmName = getenv("BOIDS_SHM");
+    bool exporting = shmName && shm_export_open(shmName, SHM_EXPORT_DEFAULT_FRAMES);
+    uint64_t step = 0;
+
     static float alignmentWeight = 1.0f;
     static float cohesionWeight = 1.0f;
     static float separationWeight = 1.0f;
@@ -42,7 +49,11 @@ int main(void)
     while (!WindowShouldClose())
     {
         if (IsKeyPressed(KEY_SPACE)) pauseSimulation = !pauseSimulation;
-        if (!pauseSimulation) UpdateBoids(alignmentWeight, cohesionWeight, separationWeight);
+        if (IsKeyPressed(KEY_C)) compactState = !compactState;
+        if (!pauseSimulation) {
+            UpdateBoids(alignmentWeight, cohesionWeight, separationWeight);
+            if (exporting) shm_export_publish(step++);
+        }
 
         if(IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)){
             if(debugBoid) debugBoid = NULL;
@@ -67,6 +78,7 @@ int main(void)
             DrawText(TextFormat("Boids drawn: %d", number_drawn), 20, 80, 30, BLUE);
             DrawText(TextFormat("Frame Time: %0.2f ms", GetFrameTime() * 1000), 20, 110, 30, BLUE);
             DrawText(TextFormat("OpenMP threads: %d", omp_get_max_threads()), 20, 140, 30, BLUE);
+            DrawText(TextFormat("Compact state (C): %s", compactState ? "on" : "off"), 20, 170, 30, BLUE);
 
             int oldTextSize = GuiGetStyle(DEFAULT, TEXT_SIZE);
             GuiSetStyle(DEFAULT, TEXT_SIZE, 24);
@@ -111,6 +123,7 @@ int main(void)
         EndDrawing();
     }
 
+    if (exporting) shm_export_close();
     CloseWindow();
 
     return 0;
@@ -0,0 +1,107 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "boids.h"
+#include "shm_export.h"
+
+static ShmExportHeader *export_header = NULL;
+static size_t export_size = 0;
+static char export_name[256];
+
+static size_t align_up(size_t n) {
+    return (n + SHM_EXPORT_ALIGN - 1) / SHM_EXPORT_ALIGN * SHM_EXPORT_ALIGN;
+}
+
+// Sized for the current boid_count; call after InitBoids().
+bool shm_export_open(const char *name, int frame_count) {
+    if (frame_count < 2) frame_count = 2;
+    if (strlen(name) >= sizeof(export_name)) {
+        fprintf(stderr, "Shared memory name too long: %s\n", name);
+        return false;
+    }
+
+    size_t frame_offset = align_up(sizeof(ShmExportHeader));
+    size_t frame_bytes = align_up(SHM_EXPORT_ALIGN + 4 * sizeof(float) * (size_t)boid_count);
+    size_t size = frame_offset + frame_bytes * frame_count;
+
+    // Unlink any stale segment rather than truncating it: a reader still
+    // mapping it keeps the old pages instead of faulting on a shrunk file.
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return false;
+    }
+    if (ftruncate(fd, size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        return false;
+    }
+
+    // ftruncate() zero-fills, so every frame starts with sequence 0 and latest 0.
+    export_header = p;
+    export_size = size;
+    strcpy(export_name, name);
+    export_header->version = SHM_EXPORT_VERSION;
+    export_header->frame_count = frame_count;
+    export_header->capacity = boid_count;
+    export_header->width = SCREEN_WIDTH;
+    export_header->height = SCREEN_HEIGHT;
+    export_header->frame_offset = frame_offset;
+    export_header->frame_bytes = frame_bytes;
+    atomic_thread_fence(memory_order_release);
+    export_header->magic = SHM_EXPORT_MAGIC;
+
+    printf("Exporting %d boids to shared memory %s (%d frames, %.1f MB)\n",
+           boid_count, name, frame_count, size / 1e6);
+    return true;
+}
+
+void shm_export_publish(uint64_t step) {
+    if (!export_header) return;
+
+    ShmFrameHeader *frame = (ShmFrameHeader *)shm_frame_at(export_header, step);
+    uint64_t sequence = atomic_load_explicit(&frame->sequence, memory_order_relaxed);
+    atomic_store_explicit(&frame->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    int count = boid_count < (int)export_header->capacity ? boid_count : (int)export_header->capacity;
+    frame->step = step;
+    frame->count = count;
+    frame->predator[0] = boids[PREDATOR_INDEX].position.x;
+    frame->predator[1] = boids[PREDATOR_INDEX].position.y;
+    frame->predator[2] = boids[PREDATOR_INDEX].velocity.x;
+    frame->predator[3] = boids[PREDATOR_INDEX].velocity.y;
+
+    // Boid is an array of structs; the frame holds two packed Vector2 arrays.
+    Vector2 *positions = (Vector2 *)shm_frame_positions(export_header, frame);
+    Vector2 *velocities = (Vector2 *)shm_frame_velocities(export_header, frame);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; i++) {
+        positions[i] = boids[i].position;
+        velocities[i] = boids[i].velocity;
+    }
+
+    atomic_store_explicit(&frame->sequence, sequence + 2, memory_order_release);
+    atomic_store_explicit(&export_header->latest, step + 1, memory_order_release);
+}
+
+// Unlinks the segment; readers that still have it mapped keep their view.
+void shm_export_close(void) {
+    if (!export_header) return;
+    munmap(export_header, export_size);
+    shm_unlink(export_name);
+    export_header = NULL;
+}
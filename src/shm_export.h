@@ -0,0 +1,91 @@
+#ifndef SHM_EXPORT_H
+#define SHM_EXPORT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Publishes each simulation step into a POSIX shared-memory ring so other
+// local processes can map it read-only. Layout of the segment:
+//
+//   ShmExportHeader, then frame_count frames of frame_bytes each:
+//   ShmFrameHeader, float positions[2 * capacity], float velocities[2 * capacity]
+//
+// Every frame is guarded by its own sequence counter (a seqlock): it is odd
+// while the writer fills the frame and advances to the next even value when
+// the frame is complete. Readers use the data in place and then check the
+// counter has not moved; the writer never waits for them.
+
+#define SHM_EXPORT_MAGIC 0x424f4944u // "BOID" as a big-endian word
+#define SHM_EXPORT_VERSION 1
+#define SHM_EXPORT_DEFAULT_FRAMES 4
+#define SHM_EXPORT_ALIGN 64
+
+typedef struct ShmExportHeader {
+    uint32_t magic;           // written last by the writer
+    uint32_t version;
+    uint32_t frame_count;
+    uint32_t capacity;        // boids per frame
+    uint32_t width;           // world size
+    uint32_t height;
+    uint64_t frame_offset;    // bytes from segment start to frame 0
+    uint64_t frame_bytes;     // stride between frames
+    _Atomic uint64_t latest;  // step + 1 of the newest complete frame, 0 if none
+} ShmExportHeader;
+
+typedef struct ShmFrameHeader {
+    _Atomic uint64_t sequence;
+    uint64_t step;
+    uint32_t count;           // boids in this frame, <= capacity
+    uint32_t reserved;
+    float predator[4];        // position x, y, velocity x, y
+} ShmFrameHeader;
+
+// Frame data starts SHM_EXPORT_ALIGN bytes after the frame header.
+_Static_assert(sizeof(ShmFrameHeader) <= SHM_EXPORT_ALIGN, "ShmFrameHeader must fit before the frame data");
+
+// Writer side, used by the simulation.
+bool shm_export_open(const char *name, int frame_count);
+void shm_export_publish(uint64_t step);
+void shm_export_close(void);
+
+// Reader side. A reader maps the segment read-only, then for each frame:
+//
+//   uint64_t seq;
+//   const ShmFrameHeader *f = shm_frame_begin(header, &seq);
+//   if (f) { ...use shm_frame_positions(header, f)...;
+//            if (!shm_frame_end(f, seq)) discard what was read; }
+
+static inline const ShmFrameHeader *shm_frame_at(const ShmExportHeader *header, uint64_t step) {
+    const char *base = (const char *)header + header->frame_offset;
+    return (const ShmFrameHeader *)(base + (step % header->frame_count) * header->frame_bytes);
+}
+
+// Newest complete frame, or NULL if none is published yet or the writer has
+// already started overwriting it.
+static inline const ShmFrameHeader *shm_frame_begin(const ShmExportHeader *header, uint64_t *sequence) {
+    uint64_t latest = atomic_load_explicit((_Atomic uint64_t *)&header->latest, memory_order_acquire);
+    if (latest == 0) return NULL;
+    const ShmFrameHeader *frame = shm_frame_at(header, latest - 1);
+    *sequence = atomic_load_explicit((_Atomic uint64_t *)&frame->sequence, memory_order_acquire);
+    if (*sequence & 1) return NULL;
+    return frame;
+}
+
+// True if nothing the reader saw since shm_frame_begin() was overwritten.
+static inline bool shm_frame_end(const ShmFrameHeader *frame, uint64_t sequence) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((_Atomic uint64_t *)&frame->sequence, memory_order_relaxed) == sequence;
+}
+
+static inline const float *shm_frame_positions(const ShmExportHeader *header, const ShmFrameHeader *frame) {
+    (void)header;
+    return (const float *)((const char *)frame + SHM_EXPORT_ALIGN);
+}
+
+static inline const float *shm_frame_velocities(const ShmExportHeader *header, const ShmFrameHeader *frame) {
+    return shm_frame_positions(header, frame) + 2 * (size_t)header->capacity;
+}
+
+#endif // SHM_EXPORT_H
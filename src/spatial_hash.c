@@ -16,6 +16,7 @@ unsigned int hash_cell(int cell_x, int cell_y) {
 void init_spatial_hash(void) {
     for (int i = 0; i < HASH_SIZE; ++i) {
         hash_table[i].length = 0;
+        if (hash_table[i].boids) continue; // re-initialised, keep the grown arrays
         hash_table[i].max_length = INITIAL_MAX_BOIDS_PER_CELL;
         hash_table[i].boids = malloc(INITIAL_MAX_BOIDS_PER_CELL * sizeof(Boid*));
         if (!hash_table[i].boids) {
@@ -31,7 +32,7 @@ void clear_spatial_hash(void) {
     }
 }
 
-void insert_boid(Boid* p) {
+void wrap_boid_position(Boid* p) {
     p->position.x = fmodf(p->position.x, (float)SCREEN_WIDTH);
     p->position.y = fmodf(p->position.y, (float)SCREEN_HEIGHT);
 
@@ -41,6 +42,10 @@ void insert_boid(Boid* p) {
     // Defensive correction for rare floating-point boundary cases
     if (p->position.x >= SCREEN_WIDTH)  p->position.x = 0.0f;
     if (p->position.y >= SCREEN_HEIGHT) p->position.y = 0.0f;
+}
+
+void insert_boid(Boid* p) {
+    wrap_boid_position(p);
 
     int cell_x = (int)(p->position.x / CELL_SIZE);
     int cell_y = (int)(p->position.y / CELL_SIZE);
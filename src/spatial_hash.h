@@ -31,6 +31,7 @@ extern HashCell hash_table[HASH_SIZE];
 void init_spatial_hash(void);
 void clear_spatial_hash(void);
 unsigned int hash_cell(int cell_x, int cell_y);
+void wrap_boid_position(Boid* p); // the wrap insert_boid() applies, idempotent
 void free_boid_node(BoidNode* node);
 
 FlockForces ComputeFlockForces(Boid *boid);
@@ -0,0 +1,199 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <unistd.h>
+
+#include "boids.h"
+#include "spatial_hash.h"
+#include "compact_state.h"
+#include "headless.h"
+
+// Accuracy and throughput of the compact neighbour state against the float
+// path.
+//
+//   boids-compact-bench [-n boids] [-W width] [-H height] [-s steps] [-S seed]
+//
+// The world defaults to the interactive density (50000 boids on 1920x1080)
+// scaled up to the requested population.
+//
+// When two of a boid's 3x3 cells share a hash bucket the float path visits
+// that bucket twice and counts its boids twice, while the compact copy is
+// indexed by cell. The one-step error is therefore reported separately for
+// those boids; only the rest measures quantisation. The drift figure covers
+// every boid and so includes both effects.
+//
+// The speedup compares the compact kernel with ComputeFlockForces() as a
+// whole: it covers the cell-sorted layout, the squared-distance tests and
+// the 8-byte records together, not the quantisation alone.
+
+typedef struct ErrorStats {
+    int boids;
+    int count_mismatches;
+    double max;
+    double sum2;
+} ErrorStats;
+
+typedef struct Snapshot {
+    Vector2 *velocity;
+    Vector2 *position;
+    int *neighbors;
+} Snapshot;
+
+// InitBoids() places boids on whole pixels, where distance ties with the
+// radii are common, so every run first advances a few steps on the float
+// path. Runs are deterministic, so each starts from the same state.
+#define WARMUP_STEPS 5
+
+static void start_run(unsigned int seed, bool compact) {
+    seed_simulation(seed);
+    InitBoids();
+    compactState = false;
+    for (int step = 0; step < WARMUP_STEPS; step++) UpdateBoids(1.0f, 1.0f, 1.0f);
+    compactState = compact;
+}
+
+static void take_snapshot(Snapshot *s) {
+    for (int i = 0; i < boid_count; i++) {
+        s->velocity[i] = boids[i].velocity;
+        s->position[i] = boids[i].position;
+        s->neighbors[i] = boids[i].neighborCount + boids[i].nearNeighborCount;
+    }
+}
+
+// True if two of the 3x3 cells around position hash to the same bucket.
+static bool bucket_collision(Vector2 position) {
+    int cell_x = (int)(position.x / CELL_SIZE);
+    int cell_y = (int)(position.y / CELL_SIZE);
+    unsigned int seen[9];
+    int n = 0;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            unsigned int index = hash_cell(WRAP_MOD(cell_x + dx, CELL_WIDTH), WRAP_MOD(cell_y + dy, CELL_HEIGHT));
+            for (int k = 0; k < n; k++)
+                if (seen[k] == index) return true;
+            seen[n++] = index;
+        }
+    }
+    return false;
+}
+
+static void print_errors(const char *label, const ErrorStats *e) {
+    if (e->boids == 0) {
+        printf("  %-28s none\n", label);
+        return;
+    }
+    printf("  %-28s %8d boids, velocity error max %.3g, rms %.3g; neighbour count differs for %d\n",
+           label, e->boids, e->max, sqrt(e->sum2 / e->boids), e->count_mismatches);
+}
+
+static double run_steps(int steps) {
+    double start = now_seconds();
+    for (int step = 0; step < steps; step++) UpdateBoids(1.0f, 1.0f, 1.0f);
+    return now_seconds() - start;
+}
+
+int main(int argc, char **argv) {
+    int count = 1000000;
+    int width = 0, height = 0;
+    int steps = 10;
+    unsigned int seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:W:H:s:S:h")) != -1) {
+        switch (opt) {
+            case 'n': count = atoi(optarg); break;
+            case 'W': width = atoi(optarg); break;
+            case 'H': height = atoi(optarg); break;
+            case 's': steps = atoi(optarg); break;
+            case 'S': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-n boids] [-W width] [-H height] [-s steps] [-S seed]\n", argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (count < 1 || steps < 1) {
+        fprintf(stderr, "boids and steps must be positive\n");
+        return 2;
+    }
+    if (width > 0 && height > 0) set_world_size(width, height);
+    else set_world_for_boids(count);
+    boid_count = count;
+    fixed_time_step = HEADLESS_TIME_STEP;
+
+    Snapshot reference, compact;
+    Snapshot *both[2] = { &reference, &compact };
+    for (int k = 0; k < 2; k++) {
+        both[k]->velocity = malloc(count * sizeof(Vector2));
+        both[k]->position = malloc(count * sizeof(Vector2));
+        both[k]->neighbors = malloc(count * sizeof(int));
+        if (!both[k]->velocity || !both[k]->position || !both[k]->neighbors) {
+            fprintf(stderr, "Failed to allocate snapshots!\n");
+            return 1;
+        }
+    }
+
+    printf("%d boids on %d x %d, %d threads\n", count, SCREEN_WIDTH, SCREEN_HEIGHT, omp_get_max_threads());
+    printf("bytes per neighbour read: float %zu, compact %zu\n",
+           2 * sizeof(Vector2), sizeof(CompactBoid));
+
+    // One step from the same state, split by whether the float path
+    // double-visits a bucket for that boid.
+    bool *collides = malloc(count * sizeof(bool));
+    if (!collides) {
+        fprintf(stderr, "Failed to allocate collision flags!\n");
+        return 1;
+    }
+    start_run(seed, false);
+    for (int i = 0; i < count; i++) collides[i] = bucket_collision(boids[i].position);
+    run_steps(1);
+    take_snapshot(&reference);
+    start_run(seed, true);
+    run_steps(1);
+    take_snapshot(&compact);
+
+    ErrorStats errors[2] = {0};
+    for (int i = 0; i < count; i++) {
+        ErrorStats *e = &errors[collides[i]];
+        double error = Vector2Length(Vector2Subtract(reference.velocity[i], compact.velocity[i]));
+        e->boids++;
+        if (error > e->max) e->max = error;
+        e->sum2 += error * error;
+        e->count_mismatches += reference.neighbors[i] != compact.neighbors[i];
+    }
+    free(collides);
+    printf("one step (MAX_SPEED %.1f):\n", MAX_SPEED);
+    print_errors("quantisation only", &errors[0]);
+    print_errors("float path double-counts", &errors[1]);
+
+    // Throughput, then how far the trajectories have drifted apart.
+    double seconds[2];
+    for (int k = 0; k < 2; k++) {
+        start_run(seed, k == 1);
+        run_steps(1); // warm-up, allocates the compact arrays
+        seconds[k] = run_steps(steps);
+        take_snapshot(both[k]);
+    }
+
+    double drift = 0.0, max_drift = 0.0;
+    for (int i = 0; i < count; i++) {
+        double d = DistanceOnTorus(reference.position[i], compact.position[i]);
+        drift += d;
+        if (d > max_drift) max_drift = d;
+    }
+    printf("after %d steps: position drift mean %.3g, max %.3g px (all boids)\n", steps + 1, drift / count, max_drift);
+
+    for (int k = 0; k < 2; k++) {
+        printf("%-8s %8.2f ms/step  %.4g boid-steps/s\n", k ? "compact" : "float",
+               seconds[k] * 1000.0 / steps, (double)count * steps / seconds[k]);
+    }
+    printf("speedup %.2fx (layout and quantisation together)\n", seconds[0] / seconds[1]);
+
+    for (int k = 0; k < 2; k++) {
+        free(both[k]->velocity);
+        free(both[k]->position);
+        free(both[k]->neighbors);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "boids.h"
+#include "spatial_hash.h"
+#include "domain.h"
+
+static int compare_id(const void *a, const void *b) {
+    int ia = ((const Boid *)a)->id, ib = ((const Boid *)b)->id;
+    return (ia > ib) - (ia < ib);
+}
+
+static void resize_boids(Domain *d, int capacity) {
+    Boid *resized = realloc(boids, (capacity + 2) * sizeof(Boid));
+    if (!resized) {
+        fprintf(stderr, "Failed to allocate %d boids!\n", capacity);
+        exit(1);
+    }
+    boids = resized;
+    d->capacity = capacity;
+}
+
+static void reserve_boids(Domain *d, int count) {
+    if (count <= d->capacity) return;
+    int capacity = d->capacity ? d->capacity : 1024;
+    while (capacity < count) capacity *= 2;
+    resize_boids(d, capacity);
+}
+
+static int owner_of(const Domain *d, const Boid *b) {
+    int cell_x = (int)(b->position.x / CELL_SIZE);
+    int cell_y = (int)(b->position.y / CELL_SIZE);
+    return d->row_rank[cell_y] * d->ranks_x + d->column_rank[cell_x];
+}
+
+// True if the 3x3 cells around (cell_x, cell_y) touch the given rank's rectangle.
+static bool near_rank(const Domain *d, int cell_x, int cell_y, int rank) {
+    int rx = rank % d->ranks_x, ry = rank / d->ranks_x;
+    bool column = false, row = false;
+    for (int delta = -1; delta <= 1; delta++) {
+        column |= d->column_rank[WRAP_MOD(cell_x + delta, CELL_WIDTH)] == rx;
+        row |= d->row_rank[WRAP_MOD(cell_y + delta, CELL_HEIGHT)] == ry;
+    }
+    return column && row;
+}
+
+// The cells PreditorAjustment() visits around the predator.
+static bool in_predator_window(Vector2 predator, int cell_x, int cell_y) {
+    int width = ((int)PREDATOR_VISUAL_RADIUS + CELL_SIZE - 1) / CELL_SIZE;
+    if (width < 1) width = 1;
+    int px = (int)(predator.x / CELL_SIZE);
+    int py = (int)(predator.y / CELL_SIZE);
+    int dx = WRAP_MOD(cell_x - px, CELL_WIDTH);
+    int dy = WRAP_MOD(cell_y - py, CELL_HEIGHT);
+    if (CELL_WIDTH - dx < dx) dx = CELL_WIDTH - dx;
+    if (CELL_HEIGHT - dy < dy) dy = CELL_HEIGHT - dy;
+    return dx <= width && dy <= width;
+}
+
+static void clear_outbox(Domain *d) {
+    for (int r = 0; r < d->transport->size; r++) d->outbox[r].length = 0;
+}
+
+// Queues ghost copies of the owned boids for every rank that needs them.
+static void queue_halo(Domain *d) {
+    int me = d->transport->rank;
+    for (int i = 0; i < d->owned_count; i++) {
+        const Boid *b = &boids[i];
+        int cell_x = (int)(b->position.x / CELL_SIZE);
+        int cell_y = (int)(b->position.y / CELL_SIZE);
+        bool everyone = in_predator_window(boids[PREDATOR_INDEX].position, cell_x, cell_y);
+        for (int r = 0; r < d->transport->size; r++) {
+            if (r != me && (everyone || near_rank(d, cell_x, cell_y, r)))
+                buffer_append(&d->outbox[r], b, sizeof(Boid));
+        }
+    }
+}
+
+// Lays the ghosts from the inbox out after the owned boids, moves the
+// predator and mouse behind them and rebuilds the spatial hash in id order.
+static void rebuild_local(Domain *d, Boid predator) {
+    int me = d->transport->rank;
+    int ghosts = 0;
+    for (int r = 0; r < d->transport->size; r++)
+        if (r != me) ghosts += d->inbox[r].length / sizeof(Boid);
+
+    reserve_boids(d, d->owned_count + ghosts);
+    Boid *next = &boids[d->owned_count];
+    for (int r = 0; r < d->transport->size; r++) {
+        if (r == me) continue;
+        memcpy(next, d->inbox[r].data, d->inbox[r].length);
+        next += d->inbox[r].length / sizeof(Boid);
+    }
+    qsort(&boids[d->owned_count], ghosts, sizeof(Boid), compare_id);
+
+    boid_count = d->owned_count + ghosts;
+    boids[PREDATOR_INDEX] = predator;
+    boids[MOUSE_INDEX] = (Boid){ .id = -2, .position = { -1.0f, -1.0f } };
+
+    clear_spatial_hash();
+    int o = 0, g = d->owned_count;
+    while (o < d->owned_count || g < boid_count) {
+        if (g == boid_count || (o < d->owned_count && boids[o].id < boids[g].id)) insert_boid(&boids[o++]);
+        else insert_boid(&boids[g++]);
+    }
+}
+
+void domain_init(Domain *d, Transport *t, int ranks_x, int ranks_y) {
+    *d = (Domain){ .transport = t, .ranks_x = ranks_x, .ranks_y = ranks_y };
+    d->rank_x = t->rank % ranks_x;
+    d->rank_y = t->rank / ranks_x;
+    d->column_rank = malloc(CELL_WIDTH * sizeof(int));
+    d->row_rank = malloc(CELL_HEIGHT * sizeof(int));
+    d->outbox = calloc(t->size, sizeof(Buffer));
+    d->inbox = calloc(t->size, sizeof(Buffer));
+    if (!d->column_rank || !d->row_rank || !d->outbox || !d->inbox) {
+        fprintf(stderr, "Failed to allocate domain!\n");
+        exit(1);
+    }
+    for (int rx = 0; rx < ranks_x; rx++)
+        for (int c = CELL_WIDTH * rx / ranks_x; c < CELL_WIDTH * (rx + 1) / ranks_x; c++) d->column_rank[c] = rx;
+    for (int ry = 0; ry < ranks_y; ry++)
+        for (int c = CELL_HEIGHT * ry / ranks_y; c < CELL_HEIGHT * (ry + 1) / ranks_y; c++) d->row_rank[c] = ry;
+
+    // Every rank draws the same flock from the same seed, one boid at a
+    // time, and keeps only its own boids and the ghosts it needs, so the
+    // initial halo is picked locally and no rank holds the whole flock.
+    init_spatial_hash();
+    Boid predator = InitialPredator();
+    int total = boid_count;
+    for (int r = 0; r < t->size; r++) d->inbox[r].length = 0;
+    for (int i = 0; i < total; i++) {
+        Boid b;
+        InitBoid(&b, i);
+        int owner = owner_of(d, &b);
+        if (owner == t->rank) {
+            reserve_boids(d, d->owned_count + 1);
+            boids[d->owned_count++] = b;
+            continue;
+        }
+        int cell_x = (int)(b.position.x / CELL_SIZE);
+        int cell_y = (int)(b.position.y / CELL_SIZE);
+        if (in_predator_window(predator.position, cell_x, cell_y) || near_rank(d, cell_x, cell_y, t->rank))
+            buffer_append(&d->inbox[owner], &b, sizeof(Boid));
+    }
+
+    // Trim the doubling slack; reserve_boids() only grows.
+    int local = d->owned_count;
+    for (int r = 0; r < t->size; r++)
+        if (r != t->rank) local += d->inbox[r].length / sizeof(Boid);
+    resize_boids(d, local);
+    rebuild_local(d, predator);
+}
+
+bool domain_step(Domain *d, float alignmentWeight, float cohesionWeight, float separationWeight) {
+    Transport *t = d->transport;
+    float step_scale = SimulationStepScale();
+
+    // Steer the owned boids against owned + ghosts from the last step
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < d->owned_count; i++) {
+        SteerBoid(i, alignmentWeight, cohesionWeight, separationWeight, step_scale);
+    }
+    Boid predator = boids[PREDATOR_INDEX];
+
+    // Commit, keeping the boids that stay and queueing the ones that leave
+    clear_outbox(d);
+    int kept = 0;
+    for (int i = 0; i < d->owned_count; i++) {
+        Boid *b = &boids[i];
+        b->velocity = b->velocity_update;
+        b->position = b->position_update;
+        wrap_boid_position(b);
+        int owner = owner_of(d, b);
+        if (owner == t->rank) boids[kept++] = *b;
+        else buffer_append(&d->outbox[owner], b, sizeof(Boid));
+    }
+    if (!t->exchange(t, d->outbox, d->inbox)) return false;
+
+    int arrived = 0;
+    for (int r = 0; r < t->size; r++)
+        if (r != t->rank) arrived += d->inbox[r].length / sizeof(Boid);
+    reserve_boids(d, kept + arrived);
+    d->owned_count = kept;
+    for (int r = 0; r < t->size; r++) {
+        if (r == t->rank) continue;
+        memcpy(&boids[d->owned_count], d->inbox[r].data, d->inbox[r].length);
+        d->owned_count += d->inbox[r].length / sizeof(Boid);
+    }
+    qsort(boids, d->owned_count, sizeof(Boid), compare_id);
+
+    // Fresh ghosts at the committed positions; the predator window uses the
+    // predator's position before it moves, as in UpdateBoids()
+    boid_count = d->owned_count;
+    boids[PREDATOR_INDEX] = predator;
+    clear_outbox(d);
+    queue_halo(d);
+    if (!t->exchange(t, d->outbox, d->inbox)) return false;
+    rebuild_local(d, predator);
+
+    MovePredator(step_scale);
+    return true;
+}
+
+void domain_free(Domain *d) {
+    for (int r = 0; r < d->transport->size; r++) {
+        buffer_free(&d->outbox[r]);
+        buffer_free(&d->inbox[r]);
+    }
+    free(d->outbox);
+    free(d->inbox);
+    free(d->column_rank);
+    free(d->row_rank);
+}
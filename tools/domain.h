@@ -0,0 +1,51 @@
+#ifndef DOMAIN_H
+#define DOMAIN_H
+
+#include <stdbool.h>
+#include "boids.h"
+#include "transport.h"
+
+// Domain decomposition of the torus across ranks (processes). The grid of
+// cells is split into ranks_x * ranks_y rectangles; each rank owns the boids
+// inside its rectangle and every step receives a one-cell (NEIGHBOR_RADIUS)
+// halo of ghost copies from its neighbours, wrapping around the torus.
+// Boids that move out of a rectangle migrate to their new owner.
+//
+// The predator is replicated: every rank also receives the boids around it
+// and moves its own copy identically. Each rank's spatial hash is built in
+// global boid id order, so with a fixed time step the result matches
+// UpdateBoids() on the whole flock exactly.
+//
+// While a Domain is live it owns the `boids` array and boid_count: owned
+// boids first, then ghosts, then the predator and mouse slots.
+//
+// Memory per rank: `boids` holds owned + ghosts (sizeof(Boid) each) and
+// grows by doubling when boids arrive; it is not trimmed after
+// domain_init(). Each peer has an outbox and an inbox kept at their largest
+// halo + migration message. The spatial hash keeps HASH_SIZE buckets of at
+// least INITIAL_MAX_BOIDS_PER_CELL pointers whatever the flock size.
+
+typedef struct Domain {
+    Transport *transport;
+    int ranks_x;
+    int ranks_y;
+    int rank_x;
+    int rank_y;
+    int *column_rank;   // cell column -> rank column
+    int *row_rank;      // cell row -> rank row
+    int owned_count;
+    int capacity;       // boids allocated, excluding predator and mouse
+    Buffer *outbox;     // one per rank
+    Buffer *inbox;
+} Domain;
+
+// Draws the same flock as InitBoids() (world, boid_count and seed must
+// already be set, identically on every rank) and keeps this rank's share.
+void domain_init(Domain *d, Transport *t, int ranks_x, int ranks_y);
+
+// One simulation step; false if the transport failed.
+bool domain_step(Domain *d, float alignmentWeight, float cohesionWeight, float separationWeight);
+
+void domain_free(Domain *d);
+
+#endif // DOMAIN_H
@@ -0,0 +1,276 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "boids.h"
+#include "spatial_hash.h"
+#include "headless.h"
+#include "transport.h"
+#include "domain.h"
+
+// Multi-process runs over the local Unix-socket transport.
+//
+//   boids-domain [-r ranks | -x ranks_x -y ranks_y] [-n boids] [-s steps]
+//                [-t threads] [-S seed] [-v] [-b]
+//
+//   -v  also run the flock in a single process with UpdateBoids() and check
+//       the decomposed result is identical
+//   -b  strong and weak scaling from 1 rank up to -r ranks (weak scaling
+//       grows the world with the flock, keeping the density)
+//
+// All runs use a fixed time step, which makes them deterministic.
+
+typedef struct FinalState {
+    Vector2 position;
+    Vector2 velocity;
+    int neighbors;
+    int written;
+} FinalState;
+
+typedef struct Run {
+    int ranks_x;
+    int ranks_y;
+    int count;
+    int width;
+    int height;
+    int steps;
+    unsigned int seed;
+    UnixMesh *mesh;
+    double *seconds;     // per rank, shared
+    FinalState *states;  // count + 1 (predator last), shared, may be NULL
+    int *failed;         // shared
+} Run;
+
+static void setup_world(const Run *run) {
+    set_world_size(run->width, run->height);
+    boid_count = run->count;
+    fixed_time_step = HEADLESS_TIME_STEP;
+    seed_simulation(run->seed);
+}
+
+static void record(FinalState *states, const Boid *b, int slot) {
+    states[slot] = (FinalState){ b->position, b->velocity, b->neighborCount + b->nearNeighborCount, 1 };
+}
+
+static void rank_main(Run *run, int rank) {
+    Transport *t = unix_mesh_attach(run->mesh, rank);
+    setup_world(run);
+    Domain d;
+    domain_init(&d, t, run->ranks_x, run->ranks_y);
+
+    double start = now_seconds();
+    for (int step = 0; step < run->steps; step++) {
+        if (!domain_step(&d, 1.0f, 1.0f, 1.0f)) {
+            fprintf(stderr, "rank %d: exchange failed at step %d\n", rank, step);
+            *run->failed = 1;
+            _exit(1);
+        }
+    }
+    run->seconds[rank] = now_seconds() - start;
+
+    if (run->states) {
+        for (int i = 0; i < d.owned_count; i++) record(run->states, &boids[i], boids[i].id);
+        if (rank == 0) record(run->states, &boids[PREDATOR_INDEX], run->count);
+    }
+    domain_free(&d);
+    t->close(t);
+}
+
+static void reference_main(Run *run) {
+    setup_world(run);
+    InitBoids();
+    double start = now_seconds();
+    for (int step = 0; step < run->steps; step++) UpdateBoids(1.0f, 1.0f, 1.0f);
+    run->seconds[0] = now_seconds() - start;
+    if (run->states) {
+        for (int i = 0; i < boid_count; i++) record(run->states, &boids[i], i);
+        record(run->states, &boids[PREDATOR_INDEX], run->count);
+    }
+}
+
+static void launch_worker(int rank, void *arg) {
+    Run *run = arg;
+    if (run->mesh) rank_main(run, rank);
+    else reference_main(run);
+}
+
+// Forks the ranks (or the single reference process when mesh is NULL) and
+// returns the slowest rank's step-loop time, or a negative value on failure.
+static double launch(Run *run, int threads) {
+    int ranks = run->mesh ? run->ranks_x * run->ranks_y : 1;
+    run->seconds = shared_alloc(ranks * sizeof(double));
+    run->failed = shared_alloc(sizeof(int));
+    pid_t *pids = start_workers(ranks, threads, launch_worker, run);
+    // The ranks hold their own ends now; release the parent's copy
+    if (run->mesh) unix_mesh_release(run->mesh);
+    run->mesh = NULL;
+    bool ok = wait_workers(pids, ranks);
+
+    double slowest = 0.0;
+    for (int rank = 0; rank < ranks; rank++)
+        if (run->seconds[rank] > slowest) slowest = run->seconds[rank];
+    ok = ok && !*run->failed;
+    munmap(run->seconds, ranks * sizeof(double));
+    munmap(run->failed, sizeof(int));
+    return ok ? slowest : -1.0;
+}
+
+static double run_decomposed(Run *run, int threads) {
+    run->mesh = unix_mesh_create(run->ranks_x * run->ranks_y);
+    return launch(run, threads);
+}
+
+static double run_reference(Run *run, int threads) {
+    run->mesh = NULL;
+    return launch(run, threads);
+}
+
+// Factors ranks into a grid whose rectangles are as square as possible.
+static void split_ranks(int ranks, int width, int height, int *ranks_x, int *ranks_y) {
+    double best = 1e30;
+    for (int x = 1; x <= ranks; x++) {
+        if (ranks % x != 0) continue;
+        int y = ranks / x;
+        double aspect = ((double)width / x) / ((double)height / y);
+        double score = fabs(log(aspect));
+        if (score < best) {
+            best = score;
+            *ranks_x = x;
+            *ranks_y = y;
+        }
+    }
+}
+
+static bool check_grid(const Run *run) {
+    if (run->ranks_x * CELL_SIZE > run->width / CELL_SIZE * CELL_SIZE ||
+        run->ranks_y * CELL_SIZE > run->height / CELL_SIZE * CELL_SIZE) {
+        fprintf(stderr, "%d x %d ranks is more than one per cell on a %d x %d world\n",
+                run->ranks_x, run->ranks_y, run->width, run->height);
+        return false;
+    }
+    return true;
+}
+
+static bool verify(Run run, int threads) {
+    size_t size = (run.count + 1) * sizeof(FinalState);
+    FinalState *expected = shared_alloc(size);
+    FinalState *actual = shared_alloc(size);
+
+    run.states = expected;
+    bool ok = run_reference(&run, threads) >= 0.0;
+    run.states = actual;
+    ok = ok && run_decomposed(&run, threads) >= 0.0;
+    if (!ok) {
+        fprintf(stderr, "verify: a run failed\n");
+        return false;
+    }
+
+    int missing = 0, mismatched = 0;
+    double max_error = 0.0;
+    for (int i = 0; i <= run.count; i++) {
+        if (!actual[i].written) {
+            missing++;
+            continue;
+        }
+        double error = fmax(Vector2Length(Vector2Subtract(expected[i].position, actual[i].position)),
+                            Vector2Length(Vector2Subtract(expected[i].velocity, actual[i].velocity)));
+        if (error > max_error) max_error = error;
+        if (memcmp(&expected[i].position, &actual[i].position, sizeof(Vector2)) != 0 ||
+            memcmp(&expected[i].velocity, &actual[i].velocity, sizeof(Vector2)) != 0 ||
+            expected[i].neighbors != actual[i].neighbors) mismatched++;
+    }
+    munmap(expected, size);
+    munmap(actual, size);
+
+    printf("verify %d x %d ranks, %d boids, %d steps: %d missing, %d differ (max error %.3g)\n",
+           run.ranks_x, run.ranks_y, run.count, run.steps, missing, mismatched, max_error);
+    return missing == 0 && mismatched == 0;
+}
+
+static void scaling(Run base, int max_ranks, int procs) {
+    printf("%-6s %6s %10s %10s %14s %10s\n", "mode", "ranks", "boids", "world", "boid-steps/s", "efficiency");
+    for (int weak = 0; weak <= 1; weak++) {
+        double baseline = 0.0;
+        for (int ranks = 1; ranks <= max_ranks; ranks *= 2) {
+            Run run = base;
+            if (weak) {
+                run.count = base.count * ranks;
+                run.width = (int)(base.width * sqrt(ranks));
+                run.height = (int)(base.height * sqrt(ranks));
+            }
+            split_ranks(ranks, run.width, run.height, &run.ranks_x, &run.ranks_y);
+            if (!check_grid(&run)) break;
+            int threads = procs / ranks > 0 ? procs / ranks : 1;
+            double seconds = run_decomposed(&run, threads);
+            if (seconds <= 0.0) {
+                fprintf(stderr, "%d ranks failed\n", ranks);
+                break;
+            }
+            double rate = (double)run.count * run.steps / seconds;
+            // Speedup per rank for strong scaling, per-rank rate kept for weak;
+            // both come to the same ratio
+            if (ranks == 1) baseline = rate;
+            double efficiency = rate / (baseline * ranks);
+            printf("%-6s %6d %10d %5dx%-5d %14.4g %9.0f%%\n", weak ? "weak" : "strong", ranks,
+                   run.count, run.width, run.height, rate, 100.0 * efficiency);
+        }
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-r ranks | -x ranks_x -y ranks_y] [-n boids] [-s steps] "
+                    "[-t threads] [-S seed] [-v] [-b]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    Run run = { .count = 50000, .width = 1920, .height = 1080, .steps = 100, .seed = 1 };
+    int ranks = 0, threads = 0;
+    bool do_verify = false, do_scaling = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:x:y:n:s:t:S:vbh")) != -1) {
+        switch (opt) {
+            case 'r': ranks = atoi(optarg); break;
+            case 'x': run.ranks_x = atoi(optarg); break;
+            case 'y': run.ranks_y = atoi(optarg); break;
+            case 'n': run.count = atoi(optarg); break;
+            case 's': run.steps = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 'S': run.seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'v': do_verify = true; break;
+            case 'b': do_scaling = true; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (run.count < 1 || run.steps < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (run.ranks_x > 0 && run.ranks_y > 0) ranks = run.ranks_x * run.ranks_y;
+    else if (ranks > 0) split_ranks(ranks, run.width, run.height, &run.ranks_x, &run.ranks_y);
+    else {
+        ranks = 4;
+        split_ranks(ranks, run.width, run.height, &run.ranks_x, &run.ranks_y);
+    }
+    if (!check_grid(&run)) return 2;
+
+    int procs = omp_get_num_procs();
+    if (threads <= 0) threads = procs / ranks > 0 ? procs / ranks : 1;
+
+    if (do_scaling) {
+        scaling(run, ranks, procs);
+        return 0;
+    }
+    if (do_verify) return verify(run, threads) ? 0 : 1;
+
+    double seconds = run_decomposed(&run, threads);
+    if (seconds < 0.0) return 1;
+    printf("%d x %d ranks x %d threads, %d boids, %d steps: %.2f s, %.4g boid-steps/s\n",
+           run.ranks_x, run.ranks_y, threads, run.count, run.steps, seconds,
+           (double)run.count * run.steps / seconds);
+    return 0;
+}
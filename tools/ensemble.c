@@ -0,0 +1,440 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <omp.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "boids.h"
+#include "spatial_hash.h"
+#include "headless.h"
+
+// Batch runner for parameter sweeps.
+//
+//   boids-ensemble SPEC [-o results.csv] [-j instances] [-t threads]
+//
+// SPEC has one parameter per line as "key = values", where values is a comma
+// separated list of numbers and/or start:stop:step ranges. Every combination
+// is run; keys that are not listed keep the interactive defaults. Example:
+//
+//   boids = 2000
+//   steps = 600
+//   alignment = 0:2:0.5
+//   neighbor_radius = 30, 40, 50
+//
+// The simulation state is process-global, so each running instance lives in
+// its own worker process and uses OpenMP threads inside it. Unless -j/-t are
+// given, a short probe of the configuration with the most boid-steps picks
+// the split between concurrent instances and threads per instance that
+// gives the highest total boid-steps/sec.
+
+#define MAX_AXES 16
+#define MAX_AXIS_VALUES 256
+#define MAX_CONFIGS 1000000
+#define PROBE_STEPS 20
+
+typedef struct Config {
+    int boids;
+    int steps;
+    int width;
+    int height;
+    unsigned int seed;
+    float alignment;
+    float cohesion;
+    float separation;
+    BoidParams params;
+} Config;
+
+typedef struct Result {
+    int done;
+    int width;                // world actually simulated, after rounding to cells
+    int height;
+    double seconds;           // UpdateBoids() calls only
+    double polarization;      // |mean heading|, averaged over the second half
+    double meanSpeed;
+    double meanNeighbors;
+    double meanNearNeighbors;
+    double predatedFraction;
+} Result;
+
+typedef struct Axis {
+    char key[32];
+    int count;
+    double values[MAX_AXIS_VALUES];
+} Axis;
+
+// Lives in a shared mapping so workers can claim configurations and report
+// results without any messaging.
+typedef struct Shared {
+    int next;
+    Result results[];
+} Shared;
+
+static Axis axes[MAX_AXES];
+static int axis_count = 0;
+static Config base_config;
+
+static bool apply_value(Config *c, const char *key, double v) {
+    if (strcmp(key, "boids") == 0) c->boids = (int)v;
+    else if (strcmp(key, "steps") == 0) c->steps = (int)v;
+    else if (strcmp(key, "width") == 0) c->width = (int)v;
+    else if (strcmp(key, "height") == 0) c->height = (int)v;
+    else if (strcmp(key, "seed") == 0) c->seed = (unsigned int)v;
+    else if (strcmp(key, "alignment") == 0) c->alignment = (float)v;
+    else if (strcmp(key, "cohesion") == 0) c->cohesion = (float)v;
+    else if (strcmp(key, "separation") == 0) c->separation = (float)v;
+    else if (strcmp(key, "neighbor_radius") == 0) c->params.neighborRadius = (float)v;
+    else if (strcmp(key, "protected_radius") == 0) c->params.protectedRadius = (float)v;
+    else if (strcmp(key, "predator_radius") == 0) c->params.predatorRadius = (float)v;
+    else if (strcmp(key, "avoid_factor") == 0) c->params.avoidFactor = (float)v;
+    else if (strcmp(key, "match_factor") == 0) c->params.matchFactor = (float)v;
+    else if (strcmp(key, "center_factor") == 0) c->params.centerFactor = (float)v;
+    else if (strcmp(key, "predator_avoid_factor") == 0) c->params.predatorAvoidFactor = (float)v;
+    else return false;
+    return true;
+}
+
+static const char *invalid_reason(const Config *c) {
+    if (c->boids < 1) return "boids must be at least 1";
+    if (c->steps < 1) return "steps must be at least 1";
+    if (c->width < CELL_SIZE || c->height < CELL_SIZE) return "world smaller than one cell";
+    if (c->params.neighborRadius <= 0.0f || c->params.neighborRadius > CELL_SIZE)
+        return "neighbor_radius must be in (0, CELL_SIZE]";
+    if (c->params.protectedRadius < 0.0f) return "protected_radius must be >= 0";
+    if (c->params.predatorRadius < 0.0f) return "predator_radius must be >= 0";
+    return NULL;
+}
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) *--end = '\0';
+    return s;
+}
+
+static bool add_value(Axis *axis, double v) {
+    if (axis->count >= MAX_AXIS_VALUES) {
+        fprintf(stderr, "Too many values for '%s' (max %d)\n", axis->key, MAX_AXIS_VALUES);
+        return false;
+    }
+    axis->values[axis->count++] = v;
+    return true;
+}
+
+static bool parse_values(Axis *axis, char *list) {
+    for (char *token = strtok(list, ","); token; token = strtok(NULL, ",")) {
+        token = trim(token);
+        double start, stop, step;
+        char extra;
+        if (sscanf(token, "%lf:%lf:%lf %c", &start, &stop, &step, &extra) == 3) {
+            if (step <= 0.0 || stop < start) {
+                fprintf(stderr, "Bad range '%s' for '%s'\n", token, axis->key);
+                return false;
+            }
+            int n = (int)floor((stop - start) / step + 1e-6) + 1;
+            for (int i = 0; i < n; i++)
+                if (!add_value(axis, start + i * step)) return false;
+        } else if (sscanf(token, "%lf %c", &start, &extra) == 1) {
+            if (!add_value(axis, start)) return false;
+        } else {
+            fprintf(stderr, "Bad value '%s' for '%s'\n", token, axis->key);
+            return false;
+        }
+    }
+    return axis->count > 0;
+}
+
+static bool parse_spec(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return false;
+    }
+
+    char line[4096];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char *text = trim(line);
+        if (*text == '\0') continue;
+
+        char *eq = strchr(text, '=');
+        if (!eq) {
+            fprintf(stderr, "%s:%d: expected 'key = values'\n", path, line_number);
+            ok = false;
+            break;
+        }
+        *eq = '\0';
+        char *key = trim(text);
+
+        Config scratch = base_config;
+        if (!apply_value(&scratch, key, 0.0)) {
+            fprintf(stderr, "%s:%d: unknown key '%s'\n", path, line_number, key);
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < axis_count; i++) {
+            if (strcmp(axes[i].key, key) == 0) {
+                fprintf(stderr, "%s:%d: '%s' given twice\n", path, line_number, key);
+                ok = false;
+            }
+        }
+        if (!ok) break;
+        if (axis_count >= MAX_AXES || strlen(key) >= sizeof(axes[0].key)) {
+            fprintf(stderr, "%s:%d: too many keys\n", path, line_number);
+            ok = false;
+            break;
+        }
+
+        Axis *axis = &axes[axis_count++];
+        strcpy(axis->key, key);
+        axis->count = 0;
+        ok = parse_values(axis, eq + 1);
+        if (!ok) fprintf(stderr, "%s:%d: no usable values for '%s'\n", path, line_number, key);
+    }
+    fclose(fp);
+    return ok;
+}
+
+// Configurations are the mixed-radix enumeration of all axes, last key fastest.
+static Config config_at(int index) {
+    Config c = base_config;
+    for (int a = axis_count - 1; a >= 0; a--) {
+        apply_value(&c, axes[a].key, axes[a].values[index % axes[a].count]);
+        index /= axes[a].count;
+    }
+    return c;
+}
+
+static double polarization(void) {
+    double sx = 0.0, sy = 0.0;
+    for (int i = 0; i < boid_count; i++) {
+        Vector2 dir = Vector2Normalize(boids[i].velocity);
+        sx += dir.x;
+        sy += dir.y;
+    }
+    return sqrt(sx * sx + sy * sy) / boid_count;
+}
+
+static void run_config(const Config *c, Result *r, int steps) {
+    set_world_size(c->width, c->height);
+    boid_count = c->boids;
+    boid_params = c->params;
+    fixed_time_step = HEADLESS_TIME_STEP;
+    seed_simulation(c->seed);
+    InitBoids();
+    r->width = SCREEN_WIDTH;
+    r->height = SCREEN_HEIGHT;
+
+    // Only UpdateBoids() is timed; the serial polarization pass is not
+    double polarizationSum = 0.0;
+    int samples = 0;
+    r->seconds = 0.0;
+    for (int step = 0; step < steps; step++) {
+        double start = now_seconds();
+        UpdateBoids(c->alignment, c->cohesion, c->separation);
+        r->seconds += now_seconds() - start;
+        if (step >= steps / 2) {
+            polarizationSum += polarization();
+            samples++;
+        }
+    }
+
+    double speed = 0.0, neighbors = 0.0, nearNeighbors = 0.0;
+    int predated = 0;
+    for (int i = 0; i < boid_count; i++) {
+        speed += Vector2Length(boids[i].velocity);
+        neighbors += boids[i].neighborCount;
+        nearNeighbors += boids[i].nearNeighborCount;
+        predated += boids[i].predated;
+    }
+    r->polarization = samples ? polarizationSum / samples : 0.0;
+    r->meanSpeed = speed / boid_count;
+    r->meanNeighbors = neighbors / boid_count;
+    r->meanNearNeighbors = nearNeighbors / boid_count;
+    r->predatedFraction = (double)predated / boid_count;
+    r->done = 1;
+}
+
+typedef struct Probe {
+    Config config;
+    Result *results;
+} Probe;
+
+static void probe_worker(int worker, void *arg) {
+    Probe *probe = arg;
+    run_config(&probe->config, &probe->results[worker], PROBE_STEPS);
+}
+
+// Aggregate boid-steps/sec of `instances` concurrent copies of `config`.
+static double probe_rate(const Config *config, int instances, int threads) {
+    Probe probe = { *config, shared_alloc(instances * sizeof(Result)) };
+    double rate = 0.0;
+    if (run_workers(instances, threads, probe_worker, &probe)) {
+        double slowest = 0.0;
+        for (int w = 0; w < instances; w++)
+            if (probe.results[w].seconds > slowest) slowest = probe.results[w].seconds;
+        if (slowest > 0.0) rate = (double)instances * config->boids * PROBE_STEPS / slowest;
+    }
+    munmap(probe.results, instances * sizeof(Result));
+    return rate;
+}
+
+// The configuration with the most boid-steps, which dominates the sweep's
+// run time; the first one on ties.
+static Config heaviest_config(int config_count) {
+    Config heaviest = config_at(0);
+    for (int i = 1; i < config_count; i++) {
+        Config c = config_at(i);
+        if ((double)c.boids * c.steps > (double)heaviest.boids * heaviest.steps) heaviest = c;
+    }
+    return heaviest;
+}
+
+static void choose_split(int config_count, int procs, int *instances, int *threads) {
+    const Config probe_config = heaviest_config(config_count);
+    fprintf(stderr, "probe: heaviest configuration, %d boids x %d steps\n", probe_config.boids, probe_config.steps);
+    double best = -1.0;
+    for (int k = 1; k <= procs && k <= config_count; k++) {
+        if (procs % k != 0) continue;
+        int t = procs / k;
+        double rate = probe_rate(&probe_config, k, t);
+        fprintf(stderr, "probe: %d instance(s) x %d thread(s): %.3g boid-steps/s\n", k, t, rate);
+        if (rate > best) {
+            best = rate;
+            *instances = k;
+            *threads = t;
+        }
+    }
+}
+
+typedef struct Sweep {
+    Shared *shared;
+    int config_count;
+} Sweep;
+
+static void sweep_worker(int worker, void *arg) {
+    (void)worker;
+    Sweep *sweep = arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&sweep->shared->next, 1, __ATOMIC_RELAXED);
+        if (i >= sweep->config_count) break;
+        Config c = config_at(i);
+        run_config(&c, &sweep->shared->results[i], c.steps);
+    }
+}
+
+static void write_results(FILE *out, const Shared *shared, int config_count) {
+    fprintf(out, "index,boids,steps,width,height,seed,alignment,cohesion,separation,"
+                 "neighbor_radius,protected_radius,predator_radius,avoid_factor,match_factor,"
+                 "center_factor,predator_avoid_factor,seconds,boid_steps_per_sec,polarization,"
+                 "mean_speed,mean_neighbors,mean_near_neighbors,predated_fraction\n");
+    for (int i = 0; i < config_count; i++) {
+        Config c = config_at(i);
+        const Result *r = &shared->results[i];
+        if (!r->done) continue;
+        fprintf(out, "%d,%d,%d,%d,%d,%u,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%.6f,%.6g,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                i, c.boids, c.steps, r->width, r->height, c.seed,
+                c.alignment, c.cohesion, c.separation,
+                c.params.neighborRadius, c.params.protectedRadius, c.params.predatorRadius,
+                c.params.avoidFactor, c.params.matchFactor, c.params.centerFactor,
+                c.params.predatorAvoidFactor,
+                r->seconds, r->seconds > 0.0 ? (double)c.boids * c.steps / r->seconds : 0.0,
+                r->polarization, r->meanSpeed, r->meanNeighbors, r->meanNearNeighbors,
+                r->predatedFraction);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s SPEC [-o results.csv] [-j instances] [-t threads]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    int instances = 0;
+    int threads = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:j:t:h")) != -1) {
+        switch (opt) {
+            case 'o': output = optarg; break;
+            case 'j': instances = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    base_config = (Config){
+        .boids = 2000, .steps = 500, .width = 1920, .height = 1080, .seed = 1,
+        .alignment = 1.0f, .cohesion = 1.0f, .separation = 1.0f,
+        .params = boid_params,
+    };
+    if (!parse_spec(argv[optind])) return 1;
+
+    long long total = 1;
+    for (int a = 0; a < axis_count; a++) {
+        total *= axes[a].count;
+        if (total > MAX_CONFIGS) {
+            fprintf(stderr, "Sweep has more than %d configurations\n", MAX_CONFIGS);
+            return 1;
+        }
+    }
+    int config_count = (int)total;
+    for (int i = 0; i < config_count; i++) {
+        Config c = config_at(i);
+        const char *reason = invalid_reason(&c);
+        if (reason) {
+            fprintf(stderr, "Configuration %d: %s\n", i, reason);
+            return 1;
+        }
+    }
+
+    int procs = omp_get_num_procs();
+    if (instances <= 0 && threads <= 0) {
+        choose_split(config_count, procs, &instances, &threads);
+    } else {
+        if (instances <= 0) instances = procs / threads > 0 ? procs / threads : 1;
+        if (threads <= 0) threads = procs / instances > 0 ? procs / instances : 1;
+    }
+    if (instances > config_count) instances = config_count;
+
+    size_t shared_size = sizeof(Shared) + config_count * sizeof(Result);
+    Sweep sweep = { shared_alloc(shared_size), config_count };
+
+    fprintf(stderr, "running %d configuration(s): %d instance(s) x %d thread(s)\n",
+            config_count, instances, threads);
+    double start = now_seconds();
+    bool ok = run_workers(instances, threads, sweep_worker, &sweep);
+    double wall = now_seconds() - start;
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_results(out, sweep.shared, config_count);
+    if (out != stdout) fclose(out);
+
+    int completed = 0;
+    long long boid_steps = 0;
+    for (int i = 0; i < config_count; i++) {
+        if (!sweep.shared->results[i].done) continue;
+        Config c = config_at(i);
+        boid_steps += (long long)c.boids * c.steps;
+        completed++;
+    }
+    fprintf(stderr, "%d/%d configuration(s) in %.2f s, aggregate %.4g boid-steps/s\n",
+            completed, config_count, wall, boid_steps / wall);
+
+    munmap(sweep.shared, shared_size);
+    return ok && completed == config_count ? 0 : 1;
+}
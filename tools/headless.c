@@ -0,0 +1,88 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "boids.h"
+#include "spatial_hash.h"
+#include "headless.h"
+
+int SCREEN_WIDTH = 1920;
+int SCREEN_HEIGHT = 1080;
+bool drawFullGlyph = false;
+bool drawDensity = false;
+bool mousePressed = false;
+bool nearestNeighboursNetwork = false;
+Boid *debugBoid = NULL;
+
+void set_world_size(int width, int height) {
+    SCREEN_WIDTH = (width / CELL_SIZE) * CELL_SIZE;
+    SCREEN_HEIGHT = (height / CELL_SIZE) * CELL_SIZE;
+    if (SCREEN_WIDTH < 3 * CELL_SIZE) SCREEN_WIDTH = 3 * CELL_SIZE;
+    if (SCREEN_HEIGHT < 3 * CELL_SIZE) SCREEN_HEIGHT = 3 * CELL_SIZE;
+}
+
+void set_world_for_boids(int count) {
+    double scale = sqrt((double)count / MAX_BOIDS);
+    set_world_size((int)(1920 * scale), (int)(1080 * scale));
+}
+
+void seed_simulation(unsigned int seed) {
+    SetRandomSeed(seed);
+    srandom(seed);
+}
+
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void *shared_alloc(size_t size) {
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    return p;
+}
+
+pid_t *start_workers(int count, int threads, void (*work)(int worker, void *arg), void *arg) {
+    pid_t *pids = malloc(count * sizeof(pid_t));
+    if (!pids) {
+        fprintf(stderr, "Failed to allocate worker table!\n");
+        exit(1);
+    }
+    for (int w = 0; w < count; w++) {
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            perror("fork");
+            exit(1);
+        }
+        if (pids[w] == 0) {
+            omp_set_num_threads(threads);
+            work(w, arg);
+            _exit(0);
+        }
+    }
+    return pids;
+}
+
+bool wait_workers(pid_t *pids, int count) {
+    bool ok = true;
+    for (int w = 0; w < count; w++) {
+        int status;
+        if (waitpid(pids[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    free(pids);
+    return ok;
+}
+
+bool run_workers(int count, int threads, void (*work)(int worker, void *arg), void *arg) {
+    return wait_workers(start_workers(count, threads, work, arg), count);
+}
@@ -0,0 +1,43 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Shared support for the command-line tools, which run the simulation
+// without opening a window. Linking headless.c provides the globals that
+// main.c defines for the interactive build.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define HEADLESS_TIME_STEP (1.0f / 60.0f)
+
+// Rounds the world down to whole cells and sets SCREEN_WIDTH/SCREEN_HEIGHT.
+void set_world_size(int width, int height);
+
+// World sized so `count` boids have the interactive density
+// (MAX_BOIDS on 1920x1080).
+void set_world_for_boids(int count);
+
+// Seeds both random sources used by InitBoids().
+void seed_simulation(unsigned int seed);
+
+// Monotonic wall clock in seconds.
+double now_seconds(void);
+
+// Anonymous MAP_SHARED memory that forked workers write results into;
+// release with munmap(). Exits on failure.
+void *shared_alloc(size_t size);
+
+// Forks `count` workers that each set `threads` OpenMP threads, run
+// work(worker, arg) and exit. The parent must not have entered an OpenMP
+// region, so every worker starts with a fresh thread pool. Exits if a
+// fork fails.
+pid_t *start_workers(int count, int threads, void (*work)(int worker, void *arg), void *arg);
+
+// Waits for and frees the workers; true if every one exited with status 0.
+bool wait_workers(pid_t *pids, int count);
+
+// start_workers() then wait_workers().
+bool run_workers(int count, int threads, void (*work)(int worker, void *arg), void *arg);
+
+#endif // HEADLESS_H
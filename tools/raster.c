@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "boids.h"
+#include "raster.h"
+
+#define CIRCLE_SEGMENTS 36 // DrawCircleLinesV() draws 10-degree segments
+#define TAIL_LENGTH 20.0f
+
+typedef struct Clip {
+    int x0, y0, x1, y1;
+} Clip;
+
+static int *tile_start = NULL;   // tile_count + 1 offsets into tile_items
+static int tile_capacity = 0;
+static int *tile_items = NULL;   // boid indices per tile, in index order
+static int item_capacity = 0;
+
+static void *grow(void *p, int *capacity, int needed, size_t size) {
+    if (needed <= *capacity) return p;
+    int grown = *capacity ? *capacity : 1024;
+    while (grown < needed) grown *= 2;
+    p = realloc(p, grown * size);
+    if (!p) {
+        fprintf(stderr, "Failed to allocate raster bins!\n");
+        exit(1);
+    }
+    *capacity = grown;
+    return p;
+}
+
+void framebuffer_init(Framebuffer *fb, int width, int height) {
+    fb->width = width;
+    fb->height = height;
+    fb->pixels = malloc((size_t)width * height * sizeof(Color));
+    if (!fb->pixels) {
+        fprintf(stderr, "Failed to allocate %d x %d framebuffer!\n", width, height);
+        exit(1);
+    }
+}
+
+void framebuffer_free(Framebuffer *fb) {
+    free(fb->pixels);
+    fb->pixels = NULL;
+}
+
+static inline void plot(Framebuffer *fb, const Clip *c, int x, int y, Color color) {
+    if (x < c->x0 || x >= c->x1 || y < c->y0 || y >= c->y1) return;
+    fb->pixels[(size_t)y * fb->width + x] = color;
+}
+
+static void fill_rect(Framebuffer *fb, const Clip *c, int x, int y, int w, int h, Color color) {
+    int x0 = x > c->x0 ? x : c->x0, x1 = x + w < c->x1 ? x + w : c->x1;
+    int y0 = y > c->y0 ? y : c->y0, y1 = y + h < c->y1 ? y + h : c->y1;
+    for (int py = y0; py < y1; py++)
+        for (int px = x0; px < x1; px++) fb->pixels[(size_t)py * fb->width + px] = color;
+}
+
+// Bresenham between the rounded endpoints.
+static void draw_line(Framebuffer *fb, const Clip *c, Vector2 a, Vector2 b, Color color) {
+    int x0 = (int)lrintf(a.x), y0 = (int)lrintf(a.y);
+    int x1 = (int)lrintf(b.x), y1 = (int)lrintf(b.y);
+    if ((x0 < c->x0 && x1 < c->x0) || (x0 >= c->x1 && x1 >= c->x1) ||
+        (y0 < c->y0 && y1 < c->y0) || (y0 >= c->y1 && y1 >= c->y1)) return;
+
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        plot(fb, c, x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+static void circle_lines(Framebuffer *fb, const Clip *c, Vector2 center, float radius, Color color) {
+    if (center.x + radius < c->x0 || center.x - radius >= c->x1 ||
+        center.y + radius < c->y0 || center.y - radius >= c->y1) return;
+    Vector2 prev = { center.x, center.y + radius };
+    for (int i = 1; i <= CIRCLE_SEGMENTS; i++) {
+        float angle = i * (360.0f / CIRCLE_SEGMENTS) * DEG2RAD;
+        Vector2 next = { center.x + sinf(angle) * radius, center.y + cosf(angle) * radius };
+        draw_line(fb, c, prev, next, color);
+        prev = next;
+    }
+}
+
+static void circle_fill(Framebuffer *fb, const Clip *c, Vector2 center, float radius, Color color) {
+    int r = (int)ceilf(radius);
+    int cx = (int)lrintf(center.x), cy = (int)lrintf(center.y);
+    for (int dy = -r; dy <= r; dy++)
+        for (int dx = -r; dx <= r; dx++)
+            if (dx * dx + dy * dy <= radius * radius) plot(fb, c, cx + dx, cy + dy, color);
+}
+
+// Mirrors DrawBoid() in boids.c.
+static void draw_boid(Framebuffer *fb, const Clip *c, const Boid *boid) {
+    float size = BOID_RADIUS;
+    Color color = drawDensity ? DensityColor(boid->neighborCount + boid->nearNeighborCount) : DARKGRAY;
+    fill_rect(fb, c, (int)floorf(boid->position.x - size / 2), (int)floorf(boid->position.y - size / 2),
+              (int)size, (int)size, color);
+    if (drawFullGlyph) {
+        Color outline = boid->predated ? GREEN : color;
+        Vector2 dir = Vector2Normalize(boid->velocity);
+        circle_lines(fb, c, boid->position, PROTECTED_RADIUS / 2.0f, outline);
+        draw_line(fb, c, boid->position, Vector2Add(boid->position, Vector2Scale(dir, -TAIL_LENGTH)), outline);
+    }
+}
+
+// Mirrors DrawPreditor() in boids.c.
+static void draw_predator(Framebuffer *fb, const Clip *c, const Boid *predator) {
+    Vector2 dir = Vector2Normalize(predator->velocity);
+    circle_lines(fb, c, predator->position, PREDATOR_VISUAL_RADIUS, BLUE);
+    circle_lines(fb, c, predator->position, PREDATOR_RADIUS, RED);
+    circle_fill(fb, c, predator->position, 2.0f, DARKGRAY);
+    draw_line(fb, c, predator->position, Vector2Add(predator->position, Vector2Scale(dir, -TAIL_LENGTH)), BLUE);
+}
+
+// Range of tile columns/rows a boid's glyph can touch; false if none.
+static bool tile_span(const Framebuffer *fb, Vector2 p, int reach, int *tx0, int *ty0, int *tx1, int *ty1) {
+    int tiles_x = (fb->width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles_y = (fb->height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int x0 = (int)floorf(p.x) - reach, x1 = (int)floorf(p.x) + reach;
+    int y0 = (int)floorf(p.y) - reach, y1 = (int)floorf(p.y) + reach;
+    if (x1 < 0 || y1 < 0 || x0 >= fb->width || y0 >= fb->height) return false;
+    *tx0 = x0 < 0 ? 0 : x0 / RASTER_TILE_SIZE;
+    *ty0 = y0 < 0 ? 0 : y0 / RASTER_TILE_SIZE;
+    *tx1 = x1 / RASTER_TILE_SIZE < tiles_x ? x1 / RASTER_TILE_SIZE : tiles_x - 1;
+    *ty1 = y1 / RASTER_TILE_SIZE < tiles_y ? y1 / RASTER_TILE_SIZE : tiles_y - 1;
+    return true;
+}
+
+void raster_boids(Framebuffer *fb) {
+    int tiles_x = (fb->width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles_y = (fb->height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles = tiles_x * tiles_y;
+    int reach = (int)BOID_RADIUS;
+    if (drawFullGlyph) {
+        int circle = (int)ceilf(PROTECTED_RADIUS / 2.0f) + 1;
+        reach = circle > TAIL_LENGTH + 1 ? circle : (int)TAIL_LENGTH + 1;
+    }
+
+    // Bin boids into tiles (serial counting sort, keeps index order)
+    tile_start = grow(tile_start, &tile_capacity, tiles + 1, sizeof(int));
+    for (int t = 0; t <= tiles; t++) tile_start[t] = 0;
+    int tx0, ty0, tx1, ty1;
+    for (int i = 0; i < boid_count; i++) {
+        if (!tile_span(fb, boids[i].position, reach, &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++) tile_start[ty * tiles_x + tx + 1]++;
+    }
+    for (int t = 0; t < tiles; t++) tile_start[t + 1] += tile_start[t];
+    tile_items = grow(tile_items, &item_capacity, tile_start[tiles] > 0 ? tile_start[tiles] : 1, sizeof(int));
+    for (int i = 0; i < boid_count; i++) {
+        if (!tile_span(fb, boids[i].position, reach, &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++)
+            for (int tx = tx0; tx <= tx1; tx++) tile_items[tile_start[ty * tiles_x + tx]++] = i;
+    }
+    // tile_start[t] now holds the end of tile t; shift back to starts
+    for (int t = tiles; t > 0; t--) tile_start[t] = tile_start[t - 1];
+    tile_start[0] = 0;
+
+    // Draw every tile independently
+    #pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < tiles; t++) {
+        Clip clip = { (t % tiles_x) * RASTER_TILE_SIZE, (t / tiles_x) * RASTER_TILE_SIZE, 0, 0 };
+        clip.x1 = clip.x0 + RASTER_TILE_SIZE < fb->width ? clip.x0 + RASTER_TILE_SIZE : fb->width;
+        clip.y1 = clip.y0 + RASTER_TILE_SIZE < fb->height ? clip.y0 + RASTER_TILE_SIZE : fb->height;
+
+        fill_rect(fb, &clip, clip.x0, clip.y0, clip.x1 - clip.x0, clip.y1 - clip.y0, RAYWHITE);
+        for (int j = tile_start[t]; j < tile_start[t + 1]; j++) draw_boid(fb, &clip, &boids[tile_items[j]]);
+        draw_predator(fb, &clip, &boids[PREDATOR_INDEX]);
+    }
+}
+
+bool raster_export_png(const Framebuffer *fb, const char *path) {
+    Image image = { fb->pixels, fb->width, fb->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return ExportImage(image, path);
+}
+
+void raster_to_yuv420(const Framebuffer *fb, uint8_t *yuv) {
+    int w = fb->width, h = fb->height;
+    uint8_t *plane_y = yuv;
+    uint8_t *plane_u = yuv + (size_t)w * h;
+    uint8_t *plane_v = plane_u + (size_t)(w / 2) * (h / 2);
+
+    #pragma omp parallel for schedule(static)
+    for (int row = 0; row < h / 2; row++) {
+        for (int col = 0; col < w / 2; col++) {
+            int r = 0, g = 0, b = 0;
+            for (int k = 0; k < 4; k++) {
+                int x = 2 * col + (k & 1), y = 2 * row + (k >> 1);
+                Color p = fb->pixels[(size_t)y * w + x];
+                plane_y[(size_t)y * w + x] = (uint8_t)(((66 * p.r + 129 * p.g + 25 * p.b + 128) >> 8) + 16);
+                r += p.r;
+                g += p.g;
+                b += p.b;
+            }
+            r /= 4;
+            g /= 4;
+            b /= 4;
+            plane_u[(size_t)row * (w / 2) + col] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            plane_v[(size_t)row * (w / 2) + col] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "boids.h"
+
+// Software rendering of the flock for runs without a display. The frame is
+// split into square tiles and each tile is drawn by one OpenMP thread, so
+// no two threads ever write the same pixel. Boids are binned to the tiles
+// their glyph can touch, in index order, so overlaps resolve exactly as in
+// DrawBoids().
+
+#define RASTER_TILE_SIZE 64
+
+typedef struct Framebuffer {
+    int width;
+    int height;
+    Color *pixels;   // row-major RGBA8, the layout of a raylib Image
+} Framebuffer;
+
+void framebuffer_init(Framebuffer *fb, int width, int height);
+void framebuffer_free(Framebuffer *fb);
+
+// DrawBoids() into fb, honouring drawDensity and drawFullGlyph, on a
+// RAYWHITE background. Boids must have been updated at least once.
+void raster_boids(Framebuffer *fb);
+
+bool raster_export_png(const Framebuffer *fb, const char *path);
+
+// Planar BT.601 4:2:0 (I420), width * height * 3 / 2 bytes; width and
+// height must be even.
+void raster_to_yuv420(const Framebuffer *fb, uint8_t *yuv);
+
+#endif // RASTER_H
@@ -0,0 +1,168 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <omp.h>
+#include <unistd.h>
+
+#include "boids.h"
+#include "headless.h"
+#include "raster.h"
+
+// Renders a headless run to PNG frames or raw I420 video.
+//
+//   boids-render [-n boids] [-W width] [-H height] [-s steps] [-e every]
+//                [-d] [-g] [-S seed] [-o frame_%05d.png] [-y file|-] [-p command]
+//
+//   -d / -g  density colours / full glyphs, as the window's checkboxes
+//   -o       PNG per frame; the pattern holds one %d for the frame number
+//   -y       raw yuv420p to a file, or stdout with '-'
+//   -p       raw yuv420p piped to a command, e.g.
+//            -p "ffmpeg -f rawvideo -pix_fmt yuv420p -s 1900x1050 -r 60 -i - boids.mp4"
+//
+// Without an output it only times rendering against the simulation.
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n boids] [-W width] [-H height] [-s steps] [-e every] [-d] [-g] [-S seed]\n"
+                    "       [-o frame_%%05d.png] [-y file|-] [-p command]\n", argv0);
+}
+
+// True if pattern is safe to give snprintf() with one int: exactly one
+// %d or %i conversion (flags, width and precision allowed), other '%'
+// only as "%%".
+static bool valid_pattern(const char *pattern) {
+    int conversions = 0;
+    for (const char *p = pattern; *p; p++) {
+        if (*p != '%') continue;
+        if (*++p == '%') continue;
+        p += strspn(p, "-+ #0");
+        p += strspn(p, "0123456789");
+        if (*p == '.') {
+            p++;
+            p += strspn(p, "0123456789");
+        }
+        if (*p != 'd' && *p != 'i') return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+int main(int argc, char **argv) {
+    int count = 50000;
+    int width = 1920, height = 1080;
+    int steps = 300;
+    int every = 1;
+    unsigned int seed = 1;
+    const char *png_pattern = NULL;
+    const char *yuv_path = NULL;
+    const char *pipe_command = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:W:H:s:e:dgS:o:y:p:h")) != -1) {
+        switch (opt) {
+            case 'n': count = atoi(optarg); break;
+            case 'W': width = atoi(optarg); break;
+            case 'H': height = atoi(optarg); break;
+            case 's': steps = atoi(optarg); break;
+            case 'e': every = atoi(optarg); break;
+            case 'd': drawDensity = true; break;
+            case 'g': drawFullGlyph = true; break;
+            case 'S': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'o': png_pattern = optarg; break;
+            case 'y': yuv_path = optarg; break;
+            case 'p': pipe_command = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (count < 1 || steps < 1 || every < 1 || (yuv_path && pipe_command)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (png_pattern && !valid_pattern(png_pattern)) {
+        fprintf(stderr, "-o needs exactly one %%d in the file name, e.g. frame_%%05d.png\n");
+        return 2;
+    }
+
+    set_world_size(width, height);
+    boid_count = count;
+    fixed_time_step = HEADLESS_TIME_STEP;
+    seed_simulation(seed);
+    InitBoids();
+
+    Framebuffer fb;
+    framebuffer_init(&fb, SCREEN_WIDTH, SCREEN_HEIGHT);
+    size_t yuv_size = (size_t)SCREEN_WIDTH * SCREEN_HEIGHT * 3 / 2;
+    uint8_t *yuv = NULL;
+    FILE *video = NULL;
+    if (yuv_path || pipe_command) {
+        signal(SIGPIPE, SIG_IGN); // a dead encoder shows up as a write error
+        if (pipe_command) video = popen(pipe_command, "w");
+        else if (strcmp(yuv_path, "-") == 0) {
+            // The simulation printf()s to stdout (e.g. when a hash cell
+            // grows), so the video gets its own copy of the descriptor and
+            // stdout is pointed at stderr.
+            int fd = dup(STDOUT_FILENO);
+            video = fd >= 0 ? fdopen(fd, "wb") : NULL;
+            if (video) dup2(STDERR_FILENO, STDOUT_FILENO);
+        }
+        else video = fopen(yuv_path, "wb");
+        yuv = malloc(yuv_size);
+        if (!video || !yuv) {
+            perror(pipe_command ? pipe_command : yuv_path);
+            return 1;
+        }
+    }
+    // Progress goes to stderr so stdout can carry video
+    fprintf(stderr, "%d boids, %d x %d frames, %d threads\n", count, SCREEN_WIDTH, SCREEN_HEIGHT,
+            omp_get_max_threads());
+
+    double simulate = 0.0, render = 0.0, output = 0.0;
+    int frames = 0;
+    bool ok = true;
+    for (int step = 0; step < steps && ok; step++) {
+        double t = now_seconds();
+        UpdateBoids(1.0f, 1.0f, 1.0f);
+        simulate += now_seconds() - t;
+        if (step % every != 0) continue;
+
+        t = now_seconds();
+        raster_boids(&fb);
+        render += now_seconds() - t;
+
+        t = now_seconds();
+        if (png_pattern) {
+            char path[4096];
+            snprintf(path, sizeof(path), png_pattern, frames);
+            ok = raster_export_png(&fb, path);
+            if (!ok) fprintf(stderr, "Failed to write %s\n", path);
+        }
+        if (video && ok) {
+            raster_to_yuv420(&fb, yuv);
+            ok = fwrite(yuv, 1, yuv_size, video) == yuv_size;
+            if (!ok) fprintf(stderr, "Video write failed\n");
+        }
+        output += now_seconds() - t;
+        frames++;
+    }
+
+    if (video) {
+        if (pipe_command) ok = pclose(video) == 0 && ok;
+        else ok = fclose(video) == 0 && ok;
+    }
+
+    double sim_rate = steps / simulate;
+    double render_rate = frames / render;
+    fprintf(stderr, "simulation %.1f steps/s (%.2f ms/step)\n", sim_rate, simulate * 1e3 / steps);
+    fprintf(stderr, "render     %.1f frames/s (%.2f ms/frame, %dpx tiles)\n",
+            render_rate, render * 1e3 / frames, RASTER_TILE_SIZE);
+    if (png_pattern || video)
+        fprintf(stderr, "output     %.1f frames/s (%.2f ms/frame)\n", frames / output, output * 1e3 / frames);
+    // A frame is due every `every` steps and costs rendering plus output
+    double frame_rate = frames / (render + output);
+    fprintf(stderr, "render + output %s the simulation\n",
+            frame_rate * every >= sim_rate ? "keeps up with" : "falls behind");
+
+    free(yuv);
+    framebuffer_free(&fb);
+    return ok ? 0 : 1;
+}
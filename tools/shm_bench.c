@@ -0,0 +1,157 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "boids.h"
+#include "shm_export.h"
+#include "headless.h"
+
+// Cost of shm_export_publish() relative to a simulation step.
+//
+//   boids-shm-bench [-n boids] [-r publishes] [-R readers] [-u update steps]
+//
+// Readers are separate processes that map the export read-only and scan
+// every frame as fast as they can while the publishes are timed.
+
+static volatile sig_atomic_t reader_stop = 0;
+
+static void on_term(int sig) {
+    (void)sig;
+    reader_stop = 1;
+}
+
+static const ShmExportHeader *map_export(const char *name, size_t *size) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    off_t end = lseek(fd, 0, SEEK_END);
+    const ShmExportHeader *header = mmap(NULL, end, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) return NULL;
+    *size = end;
+    return header;
+}
+
+static void reader_loop(const char *name) {
+    signal(SIGTERM, on_term);
+    size_t size;
+    const ShmExportHeader *header = map_export(name, &size);
+    if (!header) _exit(1);
+    double sink = 0.0;
+    while (!reader_stop) {
+        uint64_t sequence;
+        const ShmFrameHeader *frame = shm_frame_begin(header, &sequence);
+        if (!frame) continue;
+        const float *positions = shm_frame_positions(header, frame);
+        for (uint32_t i = 0; i < 2 * frame->count && i < 2 * header->capacity; i++) sink += positions[i];
+        shm_frame_end(frame, sequence);
+    }
+    _exit(sink == 42.0); // keep the scan from being optimised away
+}
+
+static void stop_readers(const pid_t *pids, int readers) {
+    for (int r = 0; r < readers; r++) kill(pids[r], SIGTERM);
+    for (int r = 0; r < readers; r++) waitpid(pids[r], NULL, 0);
+}
+
+int main(int argc, char **argv) {
+    int count = 1000000;
+    int repeats = 200;
+    int readers = 0;
+    int update_steps = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:R:u:h")) != -1) {
+        switch (opt) {
+            case 'n': count = atoi(optarg); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'R': readers = atoi(optarg); break;
+            case 'u': update_steps = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n boids] [-r publishes] [-R readers] [-u update steps]\n", argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (count < 1 || repeats < 1 || readers < 0 || update_steps < 0) {
+        fprintf(stderr, "bad arguments\n");
+        return 2;
+    }
+
+    set_world_for_boids(count);
+    boid_count = count;
+    fixed_time_step = HEADLESS_TIME_STEP;
+    seed_simulation(1);
+    InitBoids();
+
+    char name[64];
+    snprintf(name, sizeof(name), "/boids-bench-%d", (int)getpid());
+    if (!shm_export_open(name, SHM_EXPORT_DEFAULT_FRAMES)) return 1;
+
+    // Fork before the first OpenMP region so readers start clean.
+    pid_t *pids = calloc(readers > 0 ? readers : 1, sizeof(pid_t));
+    if (!pids) {
+        fprintf(stderr, "Failed to allocate reader table!\n");
+        shm_export_close();
+        return 1;
+    }
+    for (int r = 0; r < readers; r++) {
+        pids[r] = fork();
+        if (pids[r] < 0) {
+            perror("fork");
+            stop_readers(pids, r);
+            shm_export_close();
+            return 1;
+        }
+        if (pids[r] == 0) reader_loop(name);
+    }
+
+    shm_export_publish(0);
+
+    // Check a read-only mapping sees what was published.
+    size_t size;
+    const ShmExportHeader *header = map_export(name, &size);
+    uint64_t sequence;
+    const ShmFrameHeader *frame = header ? shm_frame_begin(header, &sequence) : NULL;
+    if (!frame || frame->count != (uint32_t)count ||
+        shm_frame_positions(header, frame)[2 * (count - 1)] != boids[count - 1].position.x ||
+        !shm_frame_end(frame, sequence)) {
+        fprintf(stderr, "Published frame does not read back!\n");
+        stop_readers(pids, readers);
+        shm_export_close();
+        return 1;
+    }
+
+    for (int i = 1; i <= 10; i++) shm_export_publish(i); // warm-up
+    double best = 1e30;
+    double start = now_seconds();
+    for (int i = 0; i < repeats; i++) {
+        double t = now_seconds();
+        shm_export_publish(11 + i);
+        t = now_seconds() - t;
+        if (t < best) best = t;
+    }
+    double mean = (now_seconds() - start) / repeats;
+
+    stop_readers(pids, readers);
+    free(pids);
+
+    double bytes = 4.0 * sizeof(float) * count;
+    printf("%d boids, %d threads, %d reader(s), %.1f MB per frame\n",
+           count, omp_get_max_threads(), readers, bytes / 1e6);
+    printf("publish: mean %.3f ms, best %.3f ms, %.2f GB/s\n", mean * 1e3, best * 1e3, bytes / mean / 1e9);
+
+    if (update_steps > 0) {
+        double update = now_seconds();
+        for (int i = 0; i < update_steps; i++) UpdateBoids(1.0f, 1.0f, 1.0f);
+        update = (now_seconds() - update) / update_steps;
+        printf("UpdateBoids: %.3f ms/step, publish overhead %.2f%%\n", update * 1e3, 100.0 * mean / update);
+    }
+
+    munmap((void *)header, size);
+    shm_export_close();
+    return 0;
+}
@@ -0,0 +1,127 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shm_export.h"
+
+// Example consumer of the shared-memory export. Start the simulation with
+// BOIDS_SHM=/boids, then:
+//
+//   boids-shm-reader [-n frames] [/boids]
+//
+// Each new frame is read in place (no copy) and summarised; frames the
+// writer overwrote while they were being read are counted and skipped.
+
+#define IDLE_TIMEOUT 5.0 // seconds without a new frame before giving up
+#define POLL_INTERVAL_US 1000
+
+// True if every frame the header describes lies inside the mapped segment.
+static bool segment_fits(const ShmExportHeader *header, size_t size) {
+    uint64_t min_frame = SHM_EXPORT_ALIGN + 4 * sizeof(float) * (uint64_t)header->capacity;
+    if (header->frame_count == 0 || header->frame_bytes < min_frame) return false;
+    if (header->frame_offset < sizeof(ShmExportHeader) || header->frame_offset > size) return false;
+    return header->frame_count <= (size - header->frame_offset) / header->frame_bytes;
+}
+
+int main(int argc, char **argv) {
+    long frames_wanted = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+            case 'n': frames_wanted = atol(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n frames] [name]\n", argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    const char *name = optind < argc ? argv[optind] : "/boids";
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        perror(name);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmExportHeader)) {
+        fprintf(stderr, "%s: not a boids export\n", name);
+        return 1;
+    }
+    const ShmExportHeader *header = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    long idle_polls = 0;
+    const long max_idle_polls = (long)(IDLE_TIMEOUT * 1e6 / POLL_INTERVAL_US);
+    while (atomic_load_explicit((_Atomic uint32_t *)&header->magic, memory_order_acquire) != SHM_EXPORT_MAGIC) {
+        if (++idle_polls > max_idle_polls) {
+            fprintf(stderr, "%s: writer never finished the header\n", name);
+            return 1;
+        }
+        usleep(POLL_INTERVAL_US);
+    }
+    if (header->version != SHM_EXPORT_VERSION) {
+        fprintf(stderr, "%s: version %u, expected %d\n", name, header->version, SHM_EXPORT_VERSION);
+        return 1;
+    }
+    if (!segment_fits(header, st.st_size)) {
+        fprintf(stderr, "%s: %u frames of %llu bytes for %u boids do not match a %lld byte segment\n",
+                name, header->frame_count, (unsigned long long)header->frame_bytes, header->capacity,
+                (long long)st.st_size);
+        return 1;
+    }
+    printf("%s: %u x %u world, up to %u boids, %u frames\n",
+           name, header->width, header->height, header->capacity, header->frame_count);
+
+    uint64_t last_step = UINT64_MAX;
+    long frames = 0, torn = 0;
+    idle_polls = 0;
+    while (frames_wanted == 0 || frames < frames_wanted) {
+        uint64_t sequence;
+        const ShmFrameHeader *frame = shm_frame_begin(header, &sequence);
+        if (!frame || frame->step == last_step) {
+            if (++idle_polls > max_idle_polls) break;
+            usleep(POLL_INTERVAL_US);
+            continue;
+        }
+
+        uint64_t step = frame->step;
+        uint32_t count = frame->count;
+        if (count > header->capacity) count = header->capacity;
+        const float *velocities = shm_frame_velocities(header, frame);
+        double sx = 0.0, sy = 0.0, speed = 0.0;
+        for (uint32_t i = 0; i < count; i++) {
+            float vx = velocities[2 * i], vy = velocities[2 * i + 1];
+            float length = sqrtf(vx * vx + vy * vy);
+            speed += length;
+            if (length > 0.0f) {
+                sx += vx / length;
+                sy += vy / length;
+            }
+        }
+
+        if (!shm_frame_end(frame, sequence)) {
+            torn++;
+            continue;
+        }
+        idle_polls = 0;
+        if (last_step != UINT64_MAX && step > last_step + 1)
+            printf("skipped %llu frame(s)\n", (unsigned long long)(step - last_step - 1));
+        last_step = step;
+        frames++;
+        printf("step %llu: %u boids, polarization %.3f, mean speed %.3f\n",
+               (unsigned long long)step, count,
+               count ? sqrt(sx * sx + sy * sy) / count : 0.0, count ? speed / count : 0.0);
+    }
+    printf("%ld frame(s) read, %ld torn read(s) retried\n", frames, torn);
+
+    munmap((void *)header, st.st_size);
+    return 0;
+}
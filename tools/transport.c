@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "transport.h"
+
+void buffer_reserve(Buffer *b, size_t capacity) {
+    if (capacity <= b->capacity) return;
+    size_t grown = b->capacity ? b->capacity : 4096;
+    while (grown < capacity) grown *= 2;
+    char *data = realloc(b->data, grown);
+    if (!data) {
+        fprintf(stderr, "Failed to grow message buffer!\n");
+        exit(1);
+    }
+    b->data = data;
+    b->capacity = grown;
+}
+
+void buffer_append(Buffer *b, const void *data, size_t length) {
+    buffer_reserve(b, b->length + length);
+    memcpy(b->data + b->length, data, length);
+    b->length += length;
+}
+
+void buffer_free(Buffer *b) {
+    free(b->data);
+    *b = (Buffer){0};
+}
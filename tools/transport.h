@@ -0,0 +1,42 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Message passing between the ranks of a decomposed run. A transport only
+// has to implement an all-to-all exchange of byte buffers; the domain code
+// never talks to sockets directly, so other transports (shared memory, MPI,
+// TCP) can be swapped in by filling a Transport.
+
+typedef struct Buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+void buffer_reserve(Buffer *b, size_t capacity);
+void buffer_append(Buffer *b, const void *data, size_t length);
+void buffer_free(Buffer *b);
+
+typedef struct Transport Transport;
+
+struct Transport {
+    int rank;
+    int size;
+    // send[r] goes to rank r and recv[r] is replaced by what rank r sent us,
+    // for every r including our own rank. Collective: every rank must call
+    // it the same number of times. Returns false if a peer went away.
+    bool (*exchange)(Transport *t, const Buffer *send, Buffer *recv);
+    void (*close)(Transport *t);
+};
+
+// Local transport over Unix domain sockets. Create the mesh before forking
+// the ranks, attach in each rank, then release the parent's copy.
+typedef struct UnixMesh UnixMesh;
+
+UnixMesh *unix_mesh_create(int size);
+Transport *unix_mesh_attach(UnixMesh *mesh, int rank);
+void unix_mesh_release(UnixMesh *mesh);
+
+#endif // TRANSPORT_H
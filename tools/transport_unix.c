@@ -0,0 +1,196 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "transport.h"
+
+// Full mesh of socketpairs: fds[a * size + b] is a's end of the a<->b link.
+// Messages are an 8-byte length followed by the payload. Every exchange
+// sends to and receives from all peers at once through poll(), so large
+// messages cannot deadlock on full socket buffers.
+
+struct UnixMesh {
+    int size;
+    int *fds;
+};
+
+typedef struct Progress {
+    uint64_t header;    // payload length, sent in host byte order
+    size_t done;        // bytes of header + payload moved so far
+} Progress;
+
+typedef struct UnixTransport {
+    Transport base;
+    int *fds;              // fds[peer], -1 for our own rank
+    struct pollfd *polls;
+    int *poll_peers;       // peer behind each polls[] entry
+    Progress *out;
+    Progress *in;
+} UnixTransport;
+
+UnixMesh *unix_mesh_create(int size) {
+    UnixMesh *mesh = malloc(sizeof(UnixMesh));
+    int *fds = malloc(size * size * sizeof(int));
+    if (!mesh || !fds) {
+        fprintf(stderr, "Failed to allocate socket mesh!\n");
+        exit(1);
+    }
+    mesh->size = size;
+    mesh->fds = fds;
+    for (int a = 0; a < size; a++) {
+        fds[a * size + a] = -1;
+        for (int b = a + 1; b < size; b++) {
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+                perror("socketpair");
+                exit(1);
+            }
+            fds[a * size + b] = pair[0];
+            fds[b * size + a] = pair[1];
+        }
+    }
+    return mesh;
+}
+
+void unix_mesh_release(UnixMesh *mesh) {
+    for (int i = 0; i < mesh->size * mesh->size; i++)
+        if (mesh->fds[i] >= 0) close(mesh->fds[i]);
+    free(mesh->fds);
+    free(mesh);
+}
+
+static inline bool finished(const Progress *p) {
+    return p->done >= sizeof(uint64_t) && p->done == sizeof(uint64_t) + p->header;
+}
+
+static bool unix_exchange(Transport *t, const Buffer *outbox, Buffer *inbox) {
+    UnixTransport *u = (UnixTransport *)t;
+    int pending = 0;
+
+    for (int peer = 0; peer < t->size; peer++) {
+        u->out[peer] = (Progress){ outbox[peer].length, 0 };
+        u->in[peer] = (Progress){ 0, 0 };
+        inbox[peer].length = 0;
+        if (peer == t->rank) {
+            buffer_append(&inbox[peer], outbox[peer].data, outbox[peer].length);
+            continue;
+        }
+        pending += 2;
+    }
+
+    while (pending > 0) {
+        int n = 0;
+        for (int peer = 0; peer < t->size; peer++) {
+            if (peer == t->rank) continue;
+            short events = 0;
+            if (!finished(&u->out[peer])) events |= POLLOUT;
+            if (!finished(&u->in[peer])) events |= POLLIN;
+            if (!events) continue;
+            u->polls[n] = (struct pollfd){ u->fds[peer], events, 0 };
+            u->poll_peers[n++] = peer;
+        }
+        if (poll(u->polls, n, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return false;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int peer = u->poll_peers[i];
+            int fd = u->fds[peer];
+            short revents = u->polls[i].revents;
+            if (revents & (POLLERR | POLLNVAL)) return false;
+
+            Progress *o = &u->out[peer];
+            if ((revents & POLLOUT) && !finished(o)) {
+                ssize_t w;
+                if (o->done < sizeof(uint64_t))
+                    w = send(fd, (char *)&o->header + o->done, sizeof(uint64_t) - o->done, MSG_NOSIGNAL);
+                else
+                    w = send(fd, outbox[peer].data + (o->done - sizeof(uint64_t)), sizeof(uint64_t) + o->header - o->done,
+                             MSG_NOSIGNAL);
+                if (w < 0 && errno != EAGAIN && errno != EINTR) return false;
+                if (w > 0) o->done += w;
+                if (finished(o)) pending--;
+            }
+
+            Progress *r = &u->in[peer];
+            if ((revents & (POLLIN | POLLHUP)) && !finished(r)) {
+                ssize_t got;
+                if (r->done < sizeof(uint64_t)) {
+                    got = read(fd, (char *)&r->header + r->done, sizeof(uint64_t) - r->done);
+                    if (got > 0 && r->done + got == sizeof(uint64_t)) buffer_reserve(&inbox[peer], r->header);
+                } else {
+                    got = read(fd, inbox[peer].data + (r->done - sizeof(uint64_t)), sizeof(uint64_t) + r->header - r->done);
+                }
+                if (got == 0) return false; // peer closed mid-exchange
+                if (got < 0 && errno != EAGAIN && errno != EINTR) return false;
+                if (got > 0) r->done += got;
+                if (finished(r)) {
+                    inbox[peer].length = r->header;
+                    pending--;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void unix_close(Transport *t) {
+    UnixTransport *u = (UnixTransport *)t;
+    for (int peer = 0; peer < t->size; peer++)
+        if (u->fds[peer] >= 0) close(u->fds[peer]);
+    free(u->fds);
+    free(u->polls);
+    free(u->poll_peers);
+    free(u->out);
+    free(u->in);
+    free(u);
+}
+
+// Keeps this rank's ends of the mesh and closes everything else it
+// inherited, so a dead peer shows up as end-of-file.
+Transport *unix_mesh_attach(UnixMesh *mesh, int rank) {
+    int size = mesh->size;
+    UnixTransport *u = malloc(sizeof(UnixTransport));
+    int *fds = malloc(size * sizeof(int));
+    struct pollfd *polls = malloc(size * sizeof(struct pollfd));
+    int *poll_peers = malloc(size * sizeof(int));
+    Progress *out = malloc(size * sizeof(Progress));
+    Progress *in = malloc(size * sizeof(Progress));
+    if (!u || !fds || !polls || !poll_peers || !out || !in) {
+        fprintf(stderr, "Failed to allocate transport!\n");
+        exit(1);
+    }
+
+    for (int a = 0; a < size; a++) {
+        for (int b = 0; b < size; b++) {
+            int fd = mesh->fds[a * size + b];
+            if (fd < 0) continue;
+            if (a == rank) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fds[b] = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+    fds[rank] = -1;
+    free(mesh->fds);
+    free(mesh);
+
+    u->base = (Transport){ rank, size, unix_exchange, unix_close };
+    u->fds = fds;
+    u->polls = polls;
+    u->poll_peers = poll_peers;
+    u->out = out;
+    u->in = in;
+    return &u->base;
+}